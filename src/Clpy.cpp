@@ -14,18 +14,23 @@
 #include <algorithm>
 #include <vector>
 
+using simd::float_4;
+
 #include "Filter6pButter.h"
 #define OVERSAMPLING_FACTOR 4
 
-class OverSamplingShaper {
+// Four poly channels per instance, one per float_4 lane. All per-channel
+// state is held lane-wise so the sub-step loop and post-filter run once
+// for four voices.
+class ClpyShaper {
 public:
-    OverSamplingShaper() {
+    ClpyShaper() {
         // Post-decimation low-pass: cut at original Nyquist relative to the
         // oversampled rate, i.e. 0.5 / OVERSAMPLING_FACTOR.
         postFilter.setCutoffFreq(0.5f / OVERSAMPLING_FACTOR);
     }
 
-    float process(float input, float clipValue, bool symmetric, bool oversamplingEnabled) {
+    float_4 process(float_4 input, float_4 clipValue, bool symmetric, bool oversamplingEnabled) {
         if (!oversamplingEnabled) {
             prevInput   = input;
             prevClip    = clipValue;
@@ -44,17 +49,19 @@ public:
         // sub-steps between the previous and current sample.
         // Both the audio input *and* the clip CV are linearly interpolated so
         // that fast-moving CV is also properly anti-aliased.
-        float acc = 0.f;
+        float_4 acc = 0.f;
+        float_4 inputStep = input - prevInput;
+        float_4 clipStep  = clipValue - prevClip;
         for (int s = 0; s < OVERSAMPLING_FACTOR; ++s) {
-            float frac     = (float)(s + 1) / (float)OVERSAMPLING_FACTOR;
-            float subInput = prevInput + frac * (input     - prevInput);
-            float subClip  = prevClip  + frac * (clipValue - prevClip);
+            float frac       = (float)(s + 1) / (float)OVERSAMPLING_FACTOR;
+            float_4 subInput = prevInput + frac * inputStep;
+            float_4 subClip  = prevClip  + frac * clipStep;
             acc += processShape(subInput, subClip, symmetric);
         }
-        float shapeVal = acc / (float)OVERSAMPLING_FACTOR;
+        float_4 shapeVal = acc / (float)OVERSAMPLING_FACTOR;
 
         // Post-filter removes aliasing products folded in by the nonlinearity.
-        float out = postFilter.process(shapeVal);
+        float_4 out = postFilter.process(shapeVal);
 
         prevInput = input;
         prevClip  = clipValue;
@@ -62,38 +69,39 @@ public:
     }
 
 private:
-    float processShape(float input, float clipValue, bool symmetric) {
+    float_4 processShape(float_4 input, float_4 clipValue, bool symmetric) {
         return 5.f * waveshape(input * 0.2f, clipValue, symmetric);
     }
 
-    inline float waveshape(float x, float C, bool symmetric) {
+    inline float_4 waveshape(float_4 x, float_4 C, bool symmetric) {
         constexpr float a = 0.926605548037825f;
-        float core = polySin(x) * fastExpf(-4.f * x * x / (3.14159265f * 3.14159265f));
-        float t = clamp((fabsf(x) - a) / (3.14159265f - a), 0.f, 1.f);
+        float_4 core = polySin(x) * fastExpf(-4.f * x * x / (3.14159265f * 3.14159265f));
+        float_4 t = simd::clamp((simd::fabs(x) - a) / (3.14159265f - a), 0.f, 1.f);
         t = t * t * (3.f - 2.f * t);
-        float tail = symmetric ? ((x >= 0.0f) ? C : -C) : C;
+        float_4 tail = symmetric ? simd::ifelse(x >= 0.0f, C, -C) : C;
         return core * (1.f - t) + tail * t;
     }
 
-    float polySin(float x) {
-        const float twoPi = 2.f * M_PI;
-        x = fmod(x + M_PI, twoPi);
-        if (x < 0.f) x += twoPi;
-        x -= M_PI;
+    float_4 polySin(float_4 x) {
+        const float pi = M_PI;
+        const float twoPi = 2.f * pi;
+        x += pi;
+        x -= twoPi * simd::floor(x * (1.f / twoPi));
+        x -= pi;
 
-        float x2 = x*x, x3 = x*x2, x5 = x3*x2, x7 = x5*x2, x9 = x7*x2;
+        float_4 x2 = x*x, x3 = x*x2, x5 = x3*x2, x7 = x5*x2, x9 = x7*x2;
         return x - x3/6.f + x5/120.f - x7/5040.f + x9/362880.f;
     }
 
-    inline float fastExpf(float x) {
-        x = fmaxf(-10.f, fminf(10.f, x));
+    inline float_4 fastExpf(float_4 x) {
+        x = simd::clamp(x, -10.f, 10.f);
         return 1.f + x*(1.f + x*(0.499705f + x*(0.1687389f + x*(0.0366899f + x*0.0061537f))));
     }
 
-    Filter6PButter postFilter;   // single post-decimation anti-aliasing filter
-    float prevInput   = 0.f;
-    float prevClip    = 0.f;
-    bool  initialized = false;
+    TFilter6PButter<float_4> postFilter;   // single post-decimation anti-aliasing filter
+    float_4 prevInput   = 0.f;
+    float_4 prevClip    = 0.f;
+    bool    initialized = false;
 };
 
 struct Clpy : Module {
@@ -121,19 +129,20 @@ struct Clpy : Module {
     bool symmetric = false;
     static constexpr float fourDivPiSqrd = 4.0f / (3.14159265f * 3.14159265f);
 
-    OverSamplingShaper shaperL[16];
-    OverSamplingShaper shaperR[16];
+    // Four poly channels per entry
+    ClpyShaper shaperL[4];
+    ClpyShaper shaperR[4];
 
-    // Per-channel output bandlimit filters (6-pole Butterworth), one per poly voice per side
-    Filter6PButter butterworthFilterL[16];
-    Filter6PButter butterworthFilterR[16];
+    // Output bandlimit filters (6-pole Butterworth), four poly voices per entry per side
+    TFilter6PButter<float_4> butterworthFilterL[4];
+    TFilter6PButter<float_4> butterworthFilterR[4];
     float filterCutoff = 0.4f;          // normalised cutoff [0.01, 0.49]
     bool  isBandlimitEnabled = false;
 
     bool isSupersamplingEnabled = false;
 
     void initFilters() {
-        for (int i = 0; i < 16; i++) {
+        for (int i = 0; i < 4; i++) {
             butterworthFilterL[i].setCutoffFreq(filterCutoff);
             butterworthFilterR[i].setCutoffFreq(filterCutoff);
         }
@@ -183,10 +192,11 @@ struct Clpy : Module {
     }
 
     void process(const ProcessArgs& args) override {
-        int inChannels = std::max(inputs[INL_INPUT].getChannels(), inputs[INR_INPUT].getChannels());
+        int inLChannels = inputs[INL_INPUT].getChannels();
+        int inRChannels = inputs[INR_INPUT].getChannels();
+        int inChannels = std::max(inLChannels, inRChannels);
         if (inChannels == 0) inChannels = 1;
     
-        int gainChannels  = inputs[GAIN_INPUT].getChannels();
         int clipLChannels = inputs[CLIP_L_INPUT].getChannels();
         int clipRChannels = inputs[CLIP_R_INPUT].getChannels();
     
@@ -195,43 +205,36 @@ struct Clpy : Module {
     
         float gainAtt = params[GAIN_ATT_PARAM].getValue();  
         float clipAtt = params[CLIP_ATT_PARAM].getValue();  
+        float gainParam = params[GAIN_PARAM].getValue();
+        float clipParam = 0.2f * params[CLIP_PARAM].getValue();
+
+        const float_4 laneIndex = float_4(0.f, 1.f, 2.f, 3.f);
     
-        for (int c = 0; c < inChannels; c++) {
-            // Audio inputs
-            float inL = (inputs[INL_INPUT].getChannels() > c) ? inputs[INL_INPUT].getPolyVoltage(c) : 0.f;
-            float inR = (inputs[INR_INPUT].getChannels() > c) ? inputs[INR_INPUT].getPolyVoltage(c) : inL;
-    
-            // Gain CV with poly-channel fallback to channel 0
-            float gainCV = 0.f;
-            if (gainChannels > c)       gainCV = inputs[GAIN_INPUT].getPolyVoltage(c);
-            else if (gainChannels == 1) gainCV = inputs[GAIN_INPUT].getPolyVoltage(0);
-            gainCV *= gainAtt;
+        for (int c = 0; c < inChannels; c += 4) {
+            int b = c / 4;
+
+            // Audio inputs; R lanes beyond its own channel count fall back to L
+            float_4 inL = inputs[INL_INPUT].getVoltageSimd<float_4>(c);
+            float_4 inR = inputs[INR_INPUT].getVoltageSimd<float_4>(c);
+            inR = simd::ifelse(laneIndex < (float)(inRChannels - c), inR, inL);
     
-            float gain = clamp(params[GAIN_PARAM].getValue() + gainCV, 0.f, 10.f);
+            // Gain CV, a mono cable is broadcast to every channel
+            float_4 gainCV = inputs[GAIN_INPUT].getPolyVoltageSimd<float_4>(c) * gainAtt;
+            float_4 gain = simd::clamp(gainParam + gainCV, 0.f, 10.f);
     
             inL *= gain * 0.5f;
             inR *= gain * 0.5f;
     
             // Clip / asymptote L/R with auto-normalization
-            float clipL = 0.0f;
-            float clipR = 0.0f;
-    
-            if (clipLChannels > c)       clipL = 0.2f * inputs[CLIP_L_INPUT].getPolyVoltage(c);
-            else if (clipLChannels == 1) clipL = 0.2f * inputs[CLIP_L_INPUT].getPolyVoltage(0);
-    
-            if (clipRChannels > c)       clipR = 0.2f * inputs[CLIP_R_INPUT].getPolyVoltage(c);
-            else if (clipRChannels == 1) clipR = 0.2f * inputs[CLIP_R_INPUT].getPolyVoltage(0);
-    
-            clipL *= clipAtt;
-            clipR *= clipAtt;
+            float_4 clipL = 0.2f * inputs[CLIP_L_INPUT].getPolyVoltageSimd<float_4>(c) * clipAtt;
+            float_4 clipR = 0.2f * inputs[CLIP_R_INPUT].getPolyVoltageSimd<float_4>(c) * clipAtt;
 
-            float clipParam = 0.2f * params[CLIP_PARAM].getValue();
             clipL += clipParam;
             clipR += clipParam;
     
             // Clamp final clip values
-            clipL = clamp(clipL, -10.f, 10.f);
-            clipR = clamp(clipR, -10.f, 10.f);
+            clipL = simd::clamp(clipL, -10.f, 10.f);
+            clipR = simd::clamp(clipR, -10.f, 10.f);
 
             clipL *= 0.56f;
             clipR *= 0.56f;
@@ -241,17 +244,17 @@ struct Clpy : Module {
             if (clipRChannels == 0 && clipLChannels > 0) clipR = clipL;
     
             // Apply waveshaper with optional supersampling
-            float outL = shaperL[c].process(inL, clipL, symmetric, isSupersamplingEnabled);
-            float outR = shaperR[c].process(inR, clipR, symmetric, isSupersamplingEnabled);
+            float_4 outL = shaperL[b].process(inL, clipL, symmetric, isSupersamplingEnabled);
+            float_4 outR = shaperR[b].process(inR, clipR, symmetric, isSupersamplingEnabled);
 
             // Optional post-shaping bandlimit filter for smoother output
             if (isBandlimitEnabled) {
-                outL = butterworthFilterL[c].process(outL);
-                outR = butterworthFilterR[c].process(outR);
+                outL = butterworthFilterL[b].process(outL);
+                outR = butterworthFilterR[b].process(outR);
             }
     
-            outputs[OUTL_OUTPUT].setVoltage(clamp(outL * 1.77f, -10.f, 10.f), c);
-            outputs[OUTR_OUTPUT].setVoltage(clamp(outR * 1.77f, -10.f, 10.f), c);
+            outputs[OUTL_OUTPUT].setVoltageSimd(simd::clamp(outL * 1.77f, -10.f, 10.f), c);
+            outputs[OUTR_OUTPUT].setVoltageSimd(simd::clamp(outR * 1.77f, -10.f, 10.f), c);
         }
     }
 
@@ -6,7 +6,11 @@
 
 // VCV usually uses a c++ "struct" as an object. We use the more common way of doing it, using
 // a c++ "class". The two only differ in small ways.
-class Filter6PButter {
+//
+// T is the sample type: float for one voice, or float_4 to run four voices at once
+// (all four share the same cutoff).
+template <typename T = float>
+class TFilter6PButter {
 public:
     //	void setParameters(Type type, float f, float Q, float V) {
 
@@ -26,13 +30,13 @@ public:
     //  3) Here is the online calculator we use to get the Q numbers: https://www.earlevel.com/main/2016/09/29/cascading-filters/
     void setCutoffFreq(float normalizedCutoff) {
         assert(normalizedCutoff > 0 && normalizedCutoff < .5f);
-        f[0].setParameters(rack::dsp::TBiquadFilter<float>::LOWPASS, normalizedCutoff, .51763809, 1);
-        f[1].setParameters(rack::dsp::TBiquadFilter<float>::LOWPASS, normalizedCutoff, 0.70710678, 1);
-        f[2].setParameters(rack::dsp::TBiquadFilter<float>::LOWPASS, normalizedCutoff, 1.9318517, 1);
+        f[0].setParameters(rack::dsp::TBiquadFilter<T>::LOWPASS, normalizedCutoff, .51763809, 1);
+        f[1].setParameters(rack::dsp::TBiquadFilter<T>::LOWPASS, normalizedCutoff, 0.70710678, 1);
+        f[2].setParameters(rack::dsp::TBiquadFilter<T>::LOWPASS, normalizedCutoff, 1.9318517, 1);
     }
 
     // Process takes one sample of input, and generates one sample of output.
-    float process(float x) {
+    T process(T x) {
         x = f[0].process(x);  // filter input through biquad #1
         x = f[1].process(x);  // filter the output of biquad #1 through biquad #2
         x = f[2].process(x);  // filter the output of biquad #2 through biquad #3
@@ -45,11 +49,13 @@ private:
     //
     // TBiquadFilter is a type that comes with the VCV SDK.
     // It is a very reasonable implementation of a biquad, and
-    // it may be templatized with float_4 for SIMD operation. Here
-    // we are just using float.
-    rack::dsp::TBiquadFilter<float> f[3];
+    // it may be templatized with float_4 for SIMD operation, which
+    // is what T passes through.
+    rack::dsp::TBiquadFilter<T> f[3];
 };
 
+typedef TFilter6PButter<float> Filter6PButter;
+
 #if 0  // this was an experiment - feel free to ignore it.
 class Filter12PButter {
 public:
@@ -0,0 +1,417 @@
+////////////////////////////////////////////////////////////
+//
+//   FilterDuck.h
+//
+//   written by Cody Geary
+//   Copyright 2026, MIT License
+//
+//   Output-stage DSP shared by Pressed Duck and Preeeeeeeeeeessed Duck:
+//   the ADAA polytanh saturator, its halfband-oversampled wrapper, and the
+//   expander bus that chains several ducks into one compressed mix.
+//
+////////////////////////////////////////////////////////////
+
+#pragma once
+#include <cmath>
+#include <algorithm>
+#include "rack.hpp"
+#include "plugin.hpp"
+
+// ─────────────────────────────────────────────────────────────────────────────
+// ADAA polytanh
+// ─────────────────────────────────────────────────────────────────────────────
+
+inline float duckPolyTanh(float x) {
+    float x2 = x * x;
+    return x - x * x2 * (1.0f/3.0f - x2 * (2.0f/15.0f - 17.0f/315.0f * x2));
+}
+
+// Antiderivative of duckPolyTanh, used for first-order ADAA.
+inline float duckPolyTanhAD(float x) {
+    float x2 = x * x;
+    return x2 * (0.5f - x2 * (1.0f/12.0f - x2 * (1.0f/45.0f - 17.0f/2520.0f * x2)));
+}
+
+// The polynomial only tracks tanh up to about 1.314; past that it folds over.
+static constexpr float DUCK_TANH_HEADROOM = 1.314f;
+
+struct DuckADAATanh {
+    float prevInput = 0.f;
+
+    float process(float input) {
+        input = fminf(fmaxf(input, -DUCK_TANH_HEADROOM), DUCK_TANH_HEADROOM);
+        float delta = input - prevInput;
+        float out = (fabsf(delta) > 1e-6f)
+            ? (duckPolyTanhAD(input) - duckPolyTanhAD(prevInput)) / delta
+            : duckPolyTanh(0.5f * (input + prevInput));
+        prevInput = input;
+        return out;
+    }
+};
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Polyphase halfband FIR
+//
+// A (4K-1)-tap halfband has a centre tap of 0.5, zeros at every other even
+// offset, and 2K symmetric side taps.  Split into polyphase branches, one
+// output phase of a 2x upsampler is the 2K-tap side branch and the other is
+// the input delayed by K-1 samples; the decimator is the mirror image.  Each
+// pass delays by (2K-1)/2 samples of the lower rate, so an up/down pair is an
+// integer 2K-1.
+// Coefficients are Blackman-windowed sinc, normalised for exact unity DC gain.
+// ─────────────────────────────────────────────────────────────────────────────
+
+template <int K>
+struct DuckHalfbandBranch {
+    static constexpr int TAPS = 2 * K;
+    float hist[2 * TAPS] = {};  // doubled so a tap walk never wraps
+    int pos = 0;
+
+    void push(float x) {
+        pos = (pos == 0) ? TAPS - 1 : pos - 1;
+        hist[pos] = x;
+        hist[pos + TAPS] = x;
+    }
+    float fir(const float* g) const {
+        const float* h = hist + pos;
+        float acc = 0.f;
+        for (int i = 0; i < TAPS; i++)
+            acc += g[i] * h[i];
+        return acc;
+    }
+    float tap(int i) const {
+        return hist[pos + i];
+    }
+};
+
+template <int K>
+struct DuckHalfbandCoeffs {
+    static constexpr int TAPS = 2 * K;
+    float g[TAPS];
+
+    DuckHalfbandCoeffs() {
+        const int length = 4 * K - 1;
+        const int centre = 2 * K - 1;
+        float sum = 0.f;
+        for (int i = 0; i < TAPS; i++) {
+            int n = 2 * i;               // even taps of the full filter
+            int d = n - centre;          // always odd
+            float w = 0.42f - 0.5f * std::cos(2.f * M_PI * (n + 1) / (length + 1))
+                            + 0.08f * std::cos(4.f * M_PI * (n + 1) / (length + 1));
+            g[i] = std::sin(M_PI * d * 0.5f) / (M_PI * d * 0.5f) * w;
+            sum += g[i];
+        }
+        for (int i = 0; i < TAPS; i++)
+            g[i] /= sum;
+    }
+
+    // Latency of one up- or down-sampling pass, in samples of the lower rate.
+    static constexpr float latency() { return (2 * K - 1) * 0.5f; }
+};
+
+template <int K>
+struct DuckHalfbandUpsampler {
+    DuckHalfbandBranch<K> branch;
+
+    void process(const DuckHalfbandCoeffs<K>& c, float x, float* out) {
+        branch.push(x);
+        out[0] = branch.fir(c.g);
+        out[1] = branch.tap(K - 1);
+    }
+};
+
+template <int K>
+struct DuckHalfbandDecimator {
+    DuckHalfbandBranch<K> even, odd;
+
+    float process(const DuckHalfbandCoeffs<K>& c, const float* in) {
+        even.push(in[0]);
+        odd.push(in[1]);
+        return 0.5f * (even.fir(c.g) + odd.tap(K));
+    }
+};
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Oversampled saturator
+//
+// Runs the ADAA polytanh inside a 2x or 4x halfband block while the input is
+// hot enough to generate real harmonics.  Below the clean threshold it falls
+// back to base-rate ADAA fed through a matching delay, so the two paths stay
+// time-aligned and can be crossfaded without a click.  The oversampled path
+// is warmed up for a full filter length before the crossfade starts, which
+// lines up with the clean path's delay so transients still land oversampled.
+//
+// That delay is paid all the time, not just while driven: 2x adds 15 samples
+// and 4x adds 18 samples to the whole output.  Changing the factor builds the
+// new configuration alongside the old one and crossfades between them, so the
+// latency step and the reset filters never reach the output as a click.
+// ─────────────────────────────────────────────────────────────────────────────
+
+class DuckOversampledSaturator {
+public:
+    static constexpr int OUTER_K = 8;   // base <-> 2x, the steep stage
+    static constexpr int INNER_K = 4;   // 2x <-> 4x, wide transition band
+
+    static constexpr float CLEAN_ENGAGE  = 0.30f;  // ~3% gain reduction in polytanh
+    static constexpr float CLEAN_RELEASE = 0.20f;
+
+    void setSampleRate(float sampleRate) {
+        holdSamples = (int)(0.1f * sampleRate);
+        fadeStep = 1.f / fmaxf(1.f, 0.02f * sampleRate);
+        peakDecay = std::exp(-1.f / (0.01f * sampleRate));
+    }
+
+    // 1 = base-rate ADAA only, 2 or 4 = oversampled when driven.  The switch
+    // itself happens in process(), one crossfade at a time.
+    void setFactor(int newFactor) { requestedFactor = newFactor; }
+    int getFactor() const { return paths[current].factor; }
+
+    // Constant output latency, in samples, of the given factor.
+    static int latencyFor(int factor) {
+        if (factor < 2)
+            return 0;
+        float latency = 2.f * DuckHalfbandCoeffs<OUTER_K>::latency();
+        if (factor >= 4)
+            latency += DuckHalfbandCoeffs<INNER_K>::latency();
+        latency += 0.5f / factor - 0.5f;
+        return (int)std::lround(latency);
+    }
+
+    // 0 = clean path, 1 = fully oversampled; used by the panel meter.
+    float getOversamplingLevel() const { return paths[current].osMix; }
+
+    float process(float x) {
+        if (switchMix >= 1.f && requestedFactor != paths[current].factor)
+            beginSwitch();
+
+        delayLine[delayPos] = x;
+        peak = fmaxf(fabsf(x), peak * peakDecay);
+
+        float out = processPath(paths[current], x);
+        if (switchMix < 1.f) {
+            float previous = processPath(paths[current ^ 1], x);
+            switchMix = fminf(1.f, switchMix + fadeStep);
+            out = previous + switchMix * (out - previous);
+        }
+
+        delayPos = (delayPos + 1) & (DELAY_SIZE - 1);
+        return out;
+    }
+
+private:
+    static constexpr int DELAY_SIZE = 32;
+
+    // One complete factor configuration.  Two exist so a factor change can
+    // run old and new side by side for the length of a crossfade.
+    struct Path {
+        int factor = 1;
+        int delaySamples = 0;
+
+        DuckHalfbandUpsampler<OUTER_K> outerUp;
+        DuckHalfbandDecimator<OUTER_K> outerDown;
+        DuckHalfbandUpsampler<INNER_K> innerUp;
+        DuckHalfbandDecimator<INNER_K> innerDown;
+
+        DuckADAATanh cleanShaper;
+        DuckADAATanh overShaper;
+
+        bool active = false;
+        int warmup = 0;
+        int holdCount = 0;
+        float osMix = 0.f;
+    };
+
+    void beginSwitch() {
+        current ^= 1;
+        Path& path = paths[current];
+        path = Path();
+        path.factor = requestedFactor;
+        // Integer delay that aligns the clean ADAA with the oversampled chain.
+        path.delaySamples = latencyFor(requestedFactor);
+        // Prime the ADAA with the sample it would have seen last, so the new
+        // path doesn't open with a step from zero.
+        path.cleanShaper.prevInput = delayLine[(delayPos - 1 - path.delaySamples) & (DELAY_SIZE - 1)];
+        switchMix = 0.f;
+    }
+
+    float processPath(Path& path, float x) {
+        float clean = path.cleanShaper.process(delayLine[(delayPos - path.delaySamples) & (DELAY_SIZE - 1)]);
+        if (path.factor < 2)
+            return clean;
+
+        if (peak > CLEAN_ENGAGE) {
+            if (!path.active) {
+                path.active = true;
+                path.warmup = 2 * path.delaySamples + 1;
+            }
+            path.holdCount = holdSamples;
+        } else if (path.holdCount > 0 && peak < CLEAN_RELEASE) {
+            path.holdCount--;
+        }
+
+        if (!path.active)
+            return clean;
+
+        float over = processOversampled(path, x);
+
+        if (path.warmup > 0) {
+            path.warmup--;
+        } else if (path.holdCount > 0) {
+            path.osMix = fminf(1.f, path.osMix + fadeStep);
+        } else {
+            path.osMix = fmaxf(0.f, path.osMix - fadeStep);
+            if (path.osMix == 0.f)
+                path.active = false;
+        }
+        return clean + path.osMix * (over - clean);
+    }
+
+    float processOversampled(Path& path, float x) {
+        float x2[2];
+        path.outerUp.process(outerCoeffs, x, x2);
+
+        if (path.factor == 2) {
+            x2[0] = path.overShaper.process(x2[0]);
+            x2[1] = path.overShaper.process(x2[1]);
+            return path.outerDown.process(outerCoeffs, x2);
+        }
+
+        float x4[4];
+        path.innerUp.process(innerCoeffs, x2[0], x4);
+        path.innerUp.process(innerCoeffs, x2[1], x4 + 2);
+        for (int i = 0; i < 4; i++)
+            x4[i] = path.overShaper.process(x4[i]);
+        x2[0] = path.innerDown.process(innerCoeffs, x4);
+        x2[1] = path.innerDown.process(innerCoeffs, x4 + 2);
+        return path.outerDown.process(outerCoeffs, x2);
+    }
+
+    DuckHalfbandCoeffs<OUTER_K> outerCoeffs;
+    DuckHalfbandCoeffs<INNER_K> innerCoeffs;
+
+    Path paths[2];
+    int current = 0;
+    int requestedFactor = 1;
+    float switchMix = 1.f;
+
+    float delayLine[DELAY_SIZE] = {};
+    int delayPos = 0;
+
+    int holdSamples = 4800;
+    float peak = 0.f;
+    float peakDecay = 0.998f;
+    float fadeStep = 1.f / 960.f;
+};
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Expander bus
+//
+// A duck with "send" enabled hands its pre-mix sums to the duck on its right
+// instead of running its own compression and output stage.  Ducks chain left
+// to right, and the rightmost one (the master) runs the single shared
+// compressor, sidechain, saturator and oversampler over the whole bus.
+//
+// Expander messages arrive one sample late per hop, so each duck delays its
+// own sums by the upstream depth before adding them.  That keeps the bus
+// sample-aligned at the cost of one sample of latency per chained module.
+// ─────────────────────────────────────────────────────────────────────────────
+
+struct DuckBusFrame {
+    float mixL = 0.f, mixR = 0.f;  // panned channel sum before press scaling
+    float envL = 0.f, envR = 0.f;  // sum of the channel envelope followers
+    float inputCount = 0.f;        // number of active channels
+
+    void add(const DuckBusFrame& other) {
+        mixL += other.mixL;
+        mixR += other.mixR;
+        envL += other.envL;
+        envR += other.envR;
+        inputCount += other.inputCount;
+    }
+};
+
+struct DuckBusMessage {
+    DuckBusFrame frame;
+    int depth = 0;  // expander hops the frame has travelled, 0 = nothing sent
+};
+
+inline bool isDuckModule(Module* module) {
+    return module && (module->model == modelPressedDuck || module->model == modelPreeeeeeeeeeessedDuck);
+}
+
+class DuckBus {
+public:
+    static constexpr int MAX_DEPTH = 8;
+
+    bool sendEnabled = false;  // forward to the duck on the right, set from the context menu
+
+    // Point the module's left expander at our double buffer.
+    void attach(Module* module) {
+        module->leftExpander.producerMessage = &messages[0];
+        module->leftExpander.consumerMessage = &messages[1];
+    }
+
+    // Drop whatever the previous neighbour left in the buffers.
+    void reset() {
+        messages[0] = DuckBusMessage();
+        messages[1] = DuckBusMessage();
+        depth = 0;
+    }
+
+    bool isSending(Module* module) const {
+        return sendEnabled && isDuckModule(module->rightExpander.module);
+    }
+
+    // True if this duck has bus traffic to handle even with no local inputs.
+    bool isLinked(Module* module) const {
+        return isSending(module) || upstream(module) != nullptr;
+    }
+
+    // Number of ducks feeding this one through the bus.
+    int getUpstreamCount() const { return depth; }
+
+    // Combine this duck's sums with whatever arrived from the left.
+    DuckBusFrame merge(Module* module, const DuckBusFrame& local) {
+        historyPos = (historyPos + 1) & (MAX_DEPTH - 1);
+        history[historyPos] = local;
+
+        const DuckBusMessage* message = upstream(module);
+        if (!message) {
+            depth = 0;
+            return local;
+        }
+        depth = std::min(message->depth, MAX_DEPTH - 1);
+        DuckBusFrame merged = history[(historyPos - depth) & (MAX_DEPTH - 1)];
+        merged.add(message->frame);
+        return merged;
+    }
+
+    // Send the merged frame to the right if this duck is a bus slave.  Returns
+    // false when this duck should run its own output stage.
+    bool forward(Module* module, const DuckBusFrame& frame) {
+        Module* right = module->rightExpander.module;
+        bool sending = isSending(module);
+        if (sending || (wasSending && isDuckModule(right))) {
+            DuckBusMessage* message = (DuckBusMessage*) right->leftExpander.producerMessage;
+            message->frame = sending ? frame : DuckBusFrame();
+            message->depth = sending ? depth + 1 : 0;
+            right->leftExpander.requestMessageFlip();
+        }
+        wasSending = sending;
+        return sending;
+    }
+
+private:
+    const DuckBusMessage* upstream(Module* module) const {
+        if (!isDuckModule(module->leftExpander.module))
+            return nullptr;
+        const DuckBusMessage* message = (const DuckBusMessage*) module->leftExpander.consumerMessage;
+        return (message && message->depth > 0) ? message : nullptr;
+    }
+
+    DuckBusMessage messages[2];
+    DuckBusFrame history[MAX_DEPTH];
+    int historyPos = 0;
+    int depth = 0;
+    bool wasSending = false;
+};
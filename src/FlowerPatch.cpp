@@ -19,8 +19,13 @@
 #include <string>
 #include <cmath>
 #include <array>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <memory>
 
 using namespace rack;
+using simd::float_4;
 
 std::array<std::array<float, 12>, 6> Scales = {{
     {{65.41f, 69.3f, 73.42f, 77.78f, 82.41f, 87.31f, 92.5f, 98.0f, 103.83f, 110.0f, 116.54f, 123.47f}},
@@ -36,6 +41,163 @@ static bool isAligned(void* ptr, std::size_t alignment) {
     return reinterpret_cast<uintptr_t>(ptr) % alignment == 0;
 }
 
+// Lock-free sample ring. The engine thread is the only writer: it stores a
+// sample and then publishes the new write position, so a reader that loads
+// writePos sees every sample before it. Readers never block the writer; they
+// check afterwards that the writer has not lapped what they copied.
+struct FlowerSampleRing {
+    static constexpr uint32_t SIZE = 1 << 16;
+    static constexpr uint32_t MASK = SIZE - 1;
+    float data[SIZE] = {};
+    std::atomic<uint32_t> writePos{0};
+
+    void push(float x) {
+        uint32_t w = writePos.load(std::memory_order_relaxed);
+        data[w & MASK] = x;
+        writePos.store(w + 1, std::memory_order_release);
+    }
+
+    // Copy the n samples that end at position 'end'. Returns false if the
+    // writer overwrote any of them during the copy.
+    bool copy(uint32_t end, float* out, uint32_t n) const {
+        uint32_t start = end - n;
+        for (uint32_t i = 0; i < n; i++)
+            out[i] = data[(start + i) & MASK];
+        uint32_t w = writePos.load(std::memory_order_acquire);
+        return w - start <= SIZE;
+    }
+};
+
+// Analysis results handed from the worker to the engine thread through a
+// sequence lock: the count is odd while the worker writes, and a reader
+// retries on the next sample if it changed under it.
+struct FlowerPeaks {
+    static constexpr int NUM_PEAKS = 6;
+    float vOct[NUM_PEAKS] = {};
+    float amplitude[NUM_PEAKS] = {};
+};
+
+struct FlowerPeakExchange {
+    FlowerPeaks peaks;
+    std::atomic<uint32_t> sequence{0};
+
+    void publish(const FlowerPeaks& p) {
+        uint32_t s = sequence.load(std::memory_order_relaxed);
+        sequence.store(s + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        peaks = p;
+        sequence.store(s + 2, std::memory_order_release);
+    }
+
+    // True if a complete result newer than 'lastSeen' was copied into p.
+    bool read(uint32_t& lastSeen, FlowerPeaks& p) const {
+        uint32_t s1 = sequence.load(std::memory_order_acquire);
+        if (s1 == lastSeen || (s1 & 1)) return false;
+        p = peaks;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (sequence.load(std::memory_order_relaxed) != s1) return false;
+        lastSeen = s1;
+        return true;
+    }
+};
+
+// Constant-Q analyzer: one complex one-pole resonator per displayed pitch,
+//   y[n] = x[n] + r * e^(i*w) * y[n-1]
+// with its bandwidth a fixed fraction of its frequency (one semitone), so the
+// low octaves get the long windows they need and the high octaves stay fast.
+// Each octave runs at half the rate of the one above it through a [1 2 1]/4
+// decimator, so all six octaves together cost about two octaves at full
+// rate. The twelve notes of an octave are three float_4 lanes.
+struct FlowerResonatorBank {
+    static constexpr int OCTAVES = 6;
+    static constexpr int GROUPS = 3;          // 12 notes = 3 x float_4
+    static constexpr int MAX_PRE_STAGES = 3;  // top octave runs at <= ~48 kHz
+
+    struct Decimator {
+        float x1 = 0.f, x2 = 0.f;
+        bool odd = false;
+        // Feed one sample; true (with y set) on every second one.
+        bool push(float x, float& y) {
+            float out = 0.25f * (x + 2.f * x1 + x2);
+            x2 = x1;
+            x1 = x;
+            odd = !odd;
+            if (odd) return false;
+            y = out;
+            return true;
+        }
+    };
+
+    float_4 coefRe[OCTAVES][GROUPS], coefIm[OCTAVES][GROUPS];
+    float_4 gain[OCTAVES][GROUPS];            // 2(1-r): resonance peak -> amplitude
+    float_4 stateRe[OCTAVES][GROUPS] = {}, stateIm[OCTAVES][GROUPS] = {};
+    Decimator pre[MAX_PRE_STAGES];
+    Decimator octaveDecimator[OCTAVES];
+    int preStages = 0;
+    float configuredRate = 0.f;
+
+    void configure(float sampleRate) {
+        configuredRate = sampleRate;
+        preStages = 0;
+        float topRate = sampleRate;
+        while (preStages < MAX_PRE_STAGES && topRate * 0.5f >= 40000.f) {
+            topRate *= 0.5f;
+            preStages++;
+        }
+        const float semitoneQ = 1.f / (std::pow(2.f, 1.f / 12.f) - 1.f);
+        for (int k = 0; k < OCTAVES; k++) {
+            float octaveRate = topRate / (float)(1 << (OCTAVES - 1 - k));
+            for (int n = 0; n < 12; n++) {
+                float f = Scales[k][n];
+                float omega = 2.f * M_PI * f / octaveRate;
+                float r = std::exp(-M_PI * (f / semitoneQ) / octaveRate);
+                coefRe[k][n / 4][n % 4] = r * std::cos(omega);
+                coefIm[k][n / 4][n % 4] = r * std::sin(omega);
+                gain[k][n / 4][n % 4] = 2.f * (1.f - r);
+            }
+        }
+        reset();
+    }
+
+    void reset() {
+        for (int k = 0; k < OCTAVES; k++) {
+            for (int g = 0; g < GROUPS; g++) {
+                stateRe[k][g] = 0.f;
+                stateIm[k][g] = 0.f;
+            }
+            octaveDecimator[k] = Decimator();
+        }
+        for (int s = 0; s < MAX_PRE_STAGES; s++)
+            pre[s] = Decimator();
+    }
+
+    void process(float x) {
+        for (int s = 0; s < preStages; s++)
+            if (!pre[s].push(x, x)) return;
+        for (int k = OCTAVES - 1; k >= 0; k--) {
+            for (int g = 0; g < GROUPS; g++) {
+                float_4 re = stateRe[k][g];
+                float_4 im = stateIm[k][g];
+                stateRe[k][g] = x + coefRe[k][g] * re - coefIm[k][g] * im;
+                stateIm[k][g] = coefIm[k][g] * re + coefRe[k][g] * im;
+            }
+            if (k == 0 || !octaveDecimator[k].push(x, x)) return;
+        }
+    }
+
+    // Amplitude estimate per pitch, octave-major like intensityValues.
+    void magnitudes(float* out) const {
+        for (int k = 0; k < OCTAVES; k++) {
+            for (int g = 0; g < GROUPS; g++) {
+                float_4 re = stateRe[k][g];
+                float_4 im = stateIm[k][g];
+                float_4 m = gain[k][g] * simd::sqrt(re * re + im * im);
+                m.store(&out[k * 12 + g * 4]);
+            }
+        }
+    }
+};
+
 struct FlowerPatch : Module {
     enum ParamIds {
         HUE_PARAM,
@@ -72,21 +234,65 @@ struct FlowerPatch : Module {
 
     static constexpr size_t BUFFER_SIZE = 4096;
 
-    static constexpr int MAX_HISTORY_FRAMES = 100; // Number of frames to store
+    // Analysis STFT: size 1024..16384, a new frame every size/hopDivision
+    // samples. Set via context menu, saved in patch JSON.
+    static constexpr int MIN_FFT_SIZE = 1024;
+    static constexpr int MAX_FFT_SIZE = 16384;
 
-    // Wave buffer for visualization
-    float waveBuffer[BUFFER_SIZE] = {0.0f}; // To store the waveform shape
+    static constexpr int MAX_HISTORY_FRAMES = 100; // Number of frames to store
 
-    // Frame history buffer
-    float frameHistory[MAX_HISTORY_FRAMES][BUFFER_SIZE] = {{0}}; // Store history for waveform frames
+    // The displayed waveform is read straight out of sampleRing. A frame is
+    // just its start position in the ring plus the Flower offset it was
+    // drawn with, so storing one is O(1); frames the writer has since
+    // overwritten are skipped when drawing.
+    struct WaveFrame {
+        uint32_t start = 0;
+        float offset = 0.f;
+    };
+    WaveFrame waveFrame;                        // frame being displayed now
+    WaveFrame waveHistory[MAX_HISTORY_FRAMES];  // scope trails
     int currentFrame = 0; // Index for the current frame
+
+    // Spectrum history for the waterfall, 72 bins per frame
+    float spectrumHistory[MAX_HISTORY_FRAMES][72] = {{0}};
+    int currentSpectrum = 0;
   
-    // FFT related buffers
-    dsp::RealFFT fft;  // Using RealFFT from the Rack DSP library
+    std::atomic<int> fftSize{(int)BUFFER_SIZE};
+    std::atomic<int> hopDivision{1};
+
+    // Analysis engine, set via context menu and saved in patch JSON. The
+    // constant-Q bank runs on the same worker, sample by sample, and
+    // refreshes the intensities every CQ_PUBLISH_INTERVAL samples.
+    enum AnalysisEngine {
+        FFT_ENGINE,
+        CONSTANT_Q_ENGINE
+    };
+    std::atomic<int> analysisEngine{FFT_ENGINE};
+    static constexpr uint32_t CQ_PUBLISH_INTERVAL = 512;
+    FlowerResonatorBank resonatorBank;
+    int activeEngine = FFT_ENGINE;   // worker-side copy
+    uint32_t cqSincePublish = 0;
+
+    // FFT related buffers -- owned by the analysis worker, sized for
+    // MAX_FFT_SIZE so changing the size never reallocates them.
+    std::unique_ptr<dsp::RealFFT> fft;  // Using RealFFT from the Rack DSP library
     float* fftOutput; // This will point to the aligned buffer
     float* audioBuffer;  //dynamic for FFT analysis
+    std::vector<float> window;  // Hann table for the current size
+    int analysisSize = 0;       // size fft and window were built for
+
+    // The engine thread only writes samples into sampleRing. Windowing, FFT
+    // and peak picking run on a worker thread (inline on MetaModule, which
+    // has no threads), and the peaks come back through peakExchange.
+    FlowerSampleRing sampleRing;
+    FlowerPeakExchange peakExchange;
+    uint32_t peaksSeen = 0;
+    uint32_t analyzedTo = 0;   // ring position the analysis has consumed up to
+#ifndef METAMODULE
+    std::thread worker;
+    std::atomic<bool> workerRunning{false};
+#endif
 
-    int bufferIndex = 0;
     int waveIndex = 0;
     int phaseOffset = 0; 
     float sampleRate = 44100.f; //will update in process
@@ -110,6 +316,9 @@ struct FlowerPatch : Module {
     
         // Save the state of visualizerMode
         json_object_set_new(rootJ, "visualizerMode", json_integer(visualizerMode));
+        json_object_set_new(rootJ, "fftSize", json_integer(fftSize));
+        json_object_set_new(rootJ, "hopDivision", json_integer(hopDivision));
+        json_object_set_new(rootJ, "analysisEngine", json_integer(analysisEngine));
         
         return rootJ;
     }
@@ -120,19 +329,36 @@ struct FlowerPatch : Module {
         if (visualizerModeJ) {
             visualizerMode = static_cast<VisualizerMode>(json_integer_value(visualizerModeJ));
         }                
+        json_t* fftSizeJ = json_object_get(rootJ, "fftSize");
+        if (fftSizeJ) {
+            int size = MIN_FFT_SIZE;
+            while (size < MAX_FFT_SIZE && size < json_integer_value(fftSizeJ)) size *= 2;
+            fftSize = size;
+        }
+        json_t* hopDivisionJ = json_object_get(rootJ, "hopDivision");
+        if (hopDivisionJ) {
+            int division = 1;
+            while (division < 8 && division < json_integer_value(hopDivisionJ)) division *= 2;
+            hopDivision = division;
+        }
+        json_t* analysisEngineJ = json_object_get(rootJ, "analysisEngine");
+        if (analysisEngineJ) {
+            analysisEngine = (json_integer_value(analysisEngineJ) == CONSTANT_Q_ENGINE) ? CONSTANT_Q_ENGINE : FFT_ENGINE;
+        }
     }
 
     // Update method to handle frame history
     void addFrameToHistory(const float* currentFrameData) {
-        currentFrame = (currentFrame + 1) % MAX_HISTORY_FRAMES;
-        std::copy(currentFrameData, currentFrameData + 72, frameHistory[currentFrame]);
+        currentSpectrum = (currentSpectrum + 1) % MAX_HISTORY_FRAMES;
+        std::copy(currentFrameData, currentFrameData + 72, spectrumHistory[currentSpectrum]);
     }
 
-    FlowerPatch() : Module(), fft(BUFFER_SIZE) {
+    FlowerPatch() : Module() {
 
         //special aligned memory allocation for FFT using pretty-fast-FFT-aligned-malloc
-        audioBuffer = static_cast<float*>(pffft_aligned_malloc(BUFFER_SIZE * sizeof(float)));
-        fftOutput   = static_cast<float*>(pffft_aligned_malloc(BUFFER_SIZE * sizeof(float)));
+        audioBuffer = static_cast<float*>(pffft_aligned_malloc(MAX_FFT_SIZE * sizeof(float)));
+        fftOutput   = static_cast<float*>(pffft_aligned_malloc(MAX_FFT_SIZE * sizeof(float)));
+        configureAnalysis(BUFFER_SIZE);
         
         config(NUM_PARAMS, NUM_INPUTS, NUM_OUTPUTS, NUM_LIGHTS);
         configInput(AUDIO_INPUT, "Audio");
@@ -153,16 +379,18 @@ struct FlowerPatch : Module {
         configParam(FFT_ATT_PARAM, -1.0, 1.0, 0.0, "FFT Att.");
         configInput(FFT_INPUT, "FFT CV");
 
-        // ── Seed waveBuffer with a C4 sine so the display shows in the library
-        // before any audio cable is connected.
+        // ── Seed the sample ring with a C4 sine so the display shows in the
+        // library before any audio cable is connected.
         {
             const float c4Freq = 261.63f;
             const float sr     = 44100.f;
             const float twoPi  = 2.0f * float(M_PI);
             for (size_t i = 0; i < BUFFER_SIZE; i++)
-                waveBuffer[i] = 0.5f * std::sin(twoPi * c4Freq * (float)i / sr);
+                sampleRing.push(std::sin(twoPi * c4Freq * (float)i / sr));
+            analyzedTo = sampleRing.writePos.load();  // not real input, don't analyze it
             maxVal     = 0.5f;
             sampleRate = sr;
+            waveFrame.start = analyzedTo - BUFFER_SIZE;
             // Mark C4 bin (octave index 2, note 0 = 261.63 Hz) as dominant
             // so FFT intensity highlights the C column on first display.
             intensityValues[24] = 1.0f;
@@ -176,10 +404,19 @@ struct FlowerPatch : Module {
         configOutput(FREQUENCY_OUTPUT, "Frequency Peaks (poly)");
         configOutput(AMPLITUDE_OUTPUT, "Amplitudes (poly)");
 #endif
-       
+
+#ifndef METAMODULE
+        workerRunning = true;
+        worker = std::thread([this] { workerLoop(); });
+#endif
      }
  
     ~FlowerPatch() {
+#ifndef METAMODULE
+        workerRunning = false;
+        if (worker.joinable())
+            worker.join();
+#endif
         // Free the aligned memory
         pffft_aligned_free(audioBuffer);
         pffft_aligned_free(fftOutput);
@@ -188,9 +425,33 @@ struct FlowerPatch : Module {
     }
 
     void addFrameToHistory() {
-        // Copy current waveBuffer to the history
-        std::copy(waveBuffer, waveBuffer + BUFFER_SIZE, frameHistory[currentFrame]);
+        // Remember where the current waveform starts, from its zero crossing
         currentFrame = (currentFrame + 1) % MAX_HISTORY_FRAMES;
+        waveHistory[currentFrame].start = waveFrame.start + phaseOffset;
+        waveHistory[currentFrame].offset = waveFrame.offset;
+    }
+
+    // Samples per displayed frame: enough for two periods of the lowest
+    // flower at the current sample rate.
+    int waveFrameLength() const {
+        return std::max((int)BUFFER_SIZE, (int)std::ceil(2.f * sampleRate / Scales[0][0]) + 1);
+    }
+
+    // Point waveFrame at the newest samples in the ring.
+    void captureWaveFrame() {
+        waveFrame.start = sampleRing.writePos.load(std::memory_order_acquire) - waveFrameLength();
+        waveFrame.offset = 0.11f * flowerVal;
+    }
+
+    float waveSample(const WaveFrame& frame, int i) const {
+        return (sampleRing.data[(frame.start + i) & FlowerSampleRing::MASK] - frame.offset) / 2.f;
+    }
+
+    // False once the writer has come around to the frame's samples, with
+    // a frame's worth of margin for samples written while drawing.
+    bool waveFrameValid(const WaveFrame& frame) const {
+        uint32_t w = sampleRing.writePos.load(std::memory_order_acquire);
+        return w - frame.start <= FlowerSampleRing::SIZE - (uint32_t)waveFrameLength();
     }
     
     void onSampleRateChange() override {
@@ -209,12 +470,7 @@ struct FlowerPatch : Module {
                 flowerVal = clamp(flowerVal +  params[FLOWER_ATT_PARAM].getValue() * inputs[FLOWER_INPUT].getVoltage(), -5.0f, 5.0f);
             }
             
-            bufferIndex++;
-            bufferIndex %= BUFFER_SIZE;  // Ensure we loop around correctly
-
-            audioBuffer[bufferIndex] = audioSignal ;            
-
-            waveBuffer[bufferIndex] = ( audioSignal - 0.11f * flowerVal) / 2.f;
+            sampleRing.push(audioSignal);
 
             // Update FFT knob based on parameter and possible external modulation
             FFTknob = params[FFT_PARAM].getValue() * 0.2f; // Scale knob to +-1
@@ -222,31 +478,122 @@ struct FlowerPatch : Module {
                 FFTknob = clamp(FFTknob + 0.1f * params[FFT_ATT_PARAM].getValue() * inputs[FFT_INPUT].getVoltage(), -1.0f, 1.1f);
             }
 
-            // Check alignment before triggering FFT processing
-            if (bufferIndex == 0 && isAligned(audioBuffer, 16) && isAligned(fftOutput, 16)) {
-                applyWindow(audioBuffer, BUFFER_SIZE);  // Apply windowing function
-                fft.rfft(audioBuffer, fftOutput);
-                computeIntensityValues(); // calculate the intensity based on 12 tone scale bins
-                findTopPeaks();  // identify and output top peaks as v/oct
+#ifdef METAMODULE
+            analyzeAvailable();
+#endif
+        }
+
+        // Output the top peaks as v/oct and their amplitudes
+        FlowerPeaks peaks;
+        if (peakExchange.read(peaksSeen, peaks)) {
+            outputs[FREQUENCY_OUTPUT].setChannels(FlowerPeaks::NUM_PEAKS);
+            outputs[AMPLITUDE_OUTPUT].setChannels(FlowerPeaks::NUM_PEAKS);
+            for (int i = 0; i < FlowerPeaks::NUM_PEAKS; i++) {
+                outputs[FREQUENCY_OUTPUT].setVoltage(peaks.vOct[i], i);
+                outputs[AMPLITUDE_OUTPUT].setVoltage(peaks.amplitude[i], i);
             }
         }
     }
 
+#ifndef METAMODULE
+    void workerLoop() {
+        while (workerRunning) {
+            if (!analyzeAvailable())
+                std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        }
+    }
+#endif
+
+    // Rebuild the FFT plan and window table. Runs on whichever thread does
+    // the analysis, so the two are never in use while they change.
+    void configureAnalysis(int size) {
+        analysisSize = size;
+        fft.reset(new dsp::RealFFT(size));
+        window.resize(size);
+        for (int i = 0; i < size; ++i)
+            window[i] = 0.5f * (1.0f - std::cos(2.0f * M_PI * i / (size - 1))); // Hann window
+    }
+
+    // Analyze the next STFT frame in the ring, if one is due: frames are
+    // analysisSize long and end every analysisSize/hopDivision samples. If
+    // the analysis fell more than a ring behind, skip to the newest frame.
+    // Returns true if a frame was analyzed.
+    bool analyzeAvailable() {
+        int engine = analysisEngine.load();
+        if (engine != activeEngine) {
+            activeEngine = engine;
+            analyzedTo = sampleRing.writePos.load(std::memory_order_acquire);
+            resonatorBank.reset();
+        }
+        if (engine == CONSTANT_Q_ENGINE)
+            return analyzeConstantQ();
+
+        int size = fftSize.load();
+        if (size != analysisSize)
+            configureAnalysis(size);
+        uint32_t hop = size / hopDivision.load();
+
+        uint32_t w = sampleRing.writePos.load(std::memory_order_acquire);
+        if (w - analyzedTo < hop) return false;
+        if (w - analyzedTo > FlowerSampleRing::SIZE - size)
+            analyzedTo = w - hop;
+        uint32_t end = analyzedTo + hop;
+        analyzedTo = end;
+
+        // Check alignment before triggering FFT processing
+        if (!isAligned(audioBuffer, 16) || !isAligned(fftOutput, 16)) return true;
+        if (!sampleRing.copy(end, audioBuffer, size)) return true;
+        applyWindow(audioBuffer, size);  // Apply windowing function
+        fft->rfft(audioBuffer, fftOutput);
+        computeIntensityValues(); // calculate the intensity based on 12 tone scale bins
+        findTopPeaks();  // identify and publish top peaks as v/oct
+        return true;
+    }
+
+
+    // Run every new ring sample through the resonator bank. If the worker
+    // fell more than a ring behind, skip ahead and start from silence.
+    bool analyzeConstantQ() {
+        if (resonatorBank.configuredRate != sampleRate)
+            resonatorBank.configure(sampleRate);
+
+        uint32_t w = sampleRing.writePos.load(std::memory_order_acquire);
+        if (w == analyzedTo) return false;
+        if (w - analyzedTo > FlowerSampleRing::SIZE / 2) {
+            analyzedTo = w;
+            resonatorBank.reset();
+            return true;
+        }
+        for (; analyzedTo != w; analyzedTo++) {
+            resonatorBank.process(sampleRing.data[analyzedTo & FlowerSampleRing::MASK]);
+            if (++cqSincePublish >= CQ_PUBLISH_INTERVAL) {
+                cqSincePublish = 0;
+                resonatorBank.magnitudes(intensityValues);
+                float maxIntensity = 0.0f;
+                for (size_t i = 0; i < 72; i++)
+                    maxIntensity = std::max(maxIntensity, intensityValues[i]);
+                normalizeIntensityValues(maxIntensity);
+                findTopPeaks();
+            }
+        }
+        return true;
+    }
 
     void computeIntensityValues() {
         float maxIntensity = 0.0f;
-        float freqResolution = sampleRate / BUFFER_SIZE;
+        const size_t size = analysisSize;
+        float freqResolution = sampleRate / size;
     
         for (size_t i = 0; i < 72; i++) {
             float targetFreq = Scales[i / 12][i % 12];
             size_t bin = static_cast<size_t>(std::round(targetFreq / freqResolution));
     
             // Protect against out-of-bounds access
-            if (bin < (BUFFER_SIZE / 2)) {
+            if (bin < (size / 2)) {
                 size_t indexReal = 2 * bin;
                 size_t indexImag = 2 * bin + 1;
     
-                if (indexReal + 1 < BUFFER_SIZE) {
+                if (indexReal + 1 < size) {
                     float real = fftOutput[indexReal];
                     float imag = fftOutput[indexImag];
                     intensityValues[i] = std::sqrt(real * real + imag * imag);
@@ -262,6 +609,10 @@ struct FlowerPatch : Module {
             }
         }
     
+        normalizeIntensityValues(maxIntensity);
+    }
+
+    void normalizeIntensityValues(float maxIntensity) {
         // Normalize and apply power law scaling
         for (size_t i = 0; i < 72; i++) {
             intensityValues[i] /= std::max(maxIntensity, 0.001f);  // Avoid division by zero
@@ -270,7 +621,7 @@ struct FlowerPatch : Module {
     }
 
     void findTopPeaks() {
-        const size_t numPeaks = 6;
+        const size_t numPeaks = FlowerPeaks::NUM_PEAKS;
         float topIntensities[numPeaks] = {0};
         size_t topIndices[numPeaks] = {0};
     
@@ -298,11 +649,8 @@ struct FlowerPatch : Module {
             }
         }
     
-        // Set the number of channels for the outputs
-        outputs[FREQUENCY_OUTPUT].setChannels(numPeaks);
-        outputs[AMPLITUDE_OUTPUT].setChannels(numPeaks);
-    
-        // Output the top N bins as v/oct and their amplitudes
+        // Convert the top N bins to v/oct and their amplitudes
+        FlowerPeaks peaks;
         for (size_t i = 0; i < numPeaks; i++) {
             // Convert bin index to frequency
             size_t binIndex = topIndices[i];
@@ -314,15 +662,16 @@ struct FlowerPatch : Module {
 
             // Calculate the voltage in v/oct
             float vOct = referenceVoltage + std::log2(frequency / referenceFrequency);
-            // Output v/oct and scaled amplitude for each peak
-            outputs[FREQUENCY_OUTPUT].setVoltage(vOct, i);  // Set voltage for each channel
-            outputs[AMPLITUDE_OUTPUT].setVoltage(topIntensities[i] * 10.0f, i);  // Set voltage for each channel
+            // v/oct and scaled amplitude for each peak
+            peaks.vOct[i] = vOct;
+            peaks.amplitude[i] = topIntensities[i] * 10.0f;
         }
+        peakExchange.publish(peaks);
     }
 
     void applyWindow(float* buffer, size_t size) {
         for (size_t i = 0; i < size; ++i) {
-            buffer[i] *= 0.5f * (1.0f - std::cos(2.0f * M_PI * i / (size - 1))); // Hamming window
+            buffer[i] *= window[i];
         }
     }
     
@@ -330,14 +679,20 @@ struct FlowerPatch : Module {
         maxVal = 0;
         zeroCrossIndex = -1;  //-1 indicates not found
 
-        // Find max peak in the buffer
-        for (int i = 1; i < 4096/2; i++) { 
-            if ((waveBuffer[i]) > maxVal) {
-                maxVal = (waveBuffer[i]);
+        // Find max peak and the first upward audio zero crossing in the
+        // first half of the frame, where the audio sits at -offset/2.
+        const float zeroLevel = -0.5f * waveFrame.offset;
+        const int searchLength = waveFrameLength() / 2;
+        float previous = waveSample(waveFrame, 0);
+        for (int i = 1; i < searchLength; i++) { 
+            float sample = waveSample(waveFrame, i);
+            if (sample > maxVal) {
+                maxVal = sample;
             }
-            if (audioBuffer[i] >= 0 && audioBuffer[i - 1] < 0 && zeroCrossIndex == -1) {
+            if (sample >= zeroLevel && previous < zeroLevel && zeroCrossIndex == -1) {
                 zeroCrossIndex = i;
             }           
+            previous = sample;
         }
 
         // If still not found, set to the start of the buffer
@@ -487,6 +842,7 @@ struct FlowerDisplay : TransparentWidget {
             const float spaceY = totalHeight / 6.0f;
             const float twoPi = 2.0f * M_PI;
 
+            if (module->audioConnected) module->captureWaveFrame();
             module->updatePhaseOffset();
 
             switch (module->visualizerMode) {
@@ -506,7 +862,7 @@ struct FlowerDisplay : TransparentWidget {
 
                             for (int i = 0; i < lastSample; i++) {
                                 int bufferIndex = (i + module->phaseOffset) % lastSample;
-                                float sample = module->waveBuffer[bufferIndex];
+                                float sample = module->waveSample(module->waveFrame, bufferIndex);
                                 float angle = twoPi * (i / (module->sampleRate / freq));
                                 float radius = maxRadius * (0.5f + 0.5f * sample * (0.5f / fmax(module->maxVal, 0.15f)));
 
@@ -567,7 +923,7 @@ struct FlowerDisplay : TransparentWidget {
                 
                     // Draw previous frames with fading effect
                     for (int i = 0; i < FlowerPatch::MAX_HISTORY_FRAMES; i++) {
-                        int frameIndex = (module->currentFrame - i + FlowerPatch::MAX_HISTORY_FRAMES) % FlowerPatch::MAX_HISTORY_FRAMES;
+                        int frameIndex = (module->currentSpectrum - i + FlowerPatch::MAX_HISTORY_FRAMES) % FlowerPatch::MAX_HISTORY_FRAMES;
                         float opacity = powf(fadeFactor, i) * fillKnob; // Decrease opacity for older frames and apply fill knob
                 
                         if (opacity < 0.05f) continue; // Skip frames that are too faded
@@ -586,7 +942,7 @@ struct FlowerDisplay : TransparentWidget {
                 
                             float centerX = padding + bar * barWidth * scale - drift*(flowerKnob) + drift;
                             float centerY = padding + totalHeight - drift;
-                            float intensity = module->frameHistory[frameIndex][scaleIndex * 12 + note];
+                            float intensity = module->spectrumHistory[frameIndex][scaleIndex * 12 + note];
                             if (std::isnan(intensity) || std::isinf(intensity)) { // avoid rendering errors
                                 intensity = 1.0f; // Set a fallback value
                             }
@@ -688,6 +1044,9 @@ struct FlowerDisplay : TransparentWidget {
                         float opacity = powf(fadeFactor, i) * fillKnob;
                 
                         if (opacity < 0.02f) continue;
+
+                        const FlowerPatch::WaveFrame& frame = module->waveHistory[frameIndex];
+                        if (!module->waveFrameValid(frame)) continue; // samples already overwritten
                 
                         float drift = (i / static_cast<float>(maxHistoryFrames)) * maxDrift;
                         float scale = 1.0f + (i / static_cast<float>(maxHistoryFrames));
@@ -698,11 +1057,9 @@ struct FlowerDisplay : TransparentWidget {
                         float freq = Scales[selectedFlower / 12][selectedFlower % 12];
                         int lastSample = static_cast<int>(4 * (module->sampleRate / freq)); // Draw 2x as many samples
                 
-                        const auto& frameData = module->frameHistory[frameIndex];
-                
                         for (int j = 0; j < lastSample; j++) {
                             int bufferIndex = j % (lastSample / 2); // Handle wrapping around
-                            float sample = frameData[bufferIndex];
+                            float sample = module->waveSample(frame, bufferIndex);
                
                             // Avoid NaN or inf values
                             if (std::isnan(sample) || std::isinf(sample)) {
@@ -741,7 +1098,7 @@ struct FlowerDisplay : TransparentWidget {
       
                     for (int i = 0; i < lastSample; i++) {
                         int bufferIndex = (i + module->phaseOffset) % (lastSample / 2); // Handle wrapping around
-                        float sample = module->waveBuffer[bufferIndex];
+                        float sample = module->waveSample(module->waveFrame, bufferIndex);
                
                         // Avoid NaN or inf values
                         if (std::isnan(sample) || std::isinf(sample)) {
@@ -904,6 +1261,84 @@ struct FlowerPatchWidget : ModuleWidget {
         scopeModeItem->text = "Scope Mode";
         scopeModeItem->flowerPatchModule = flowerPatchModule;
         menu->addChild(scopeModeItem);
+
+        // Analysis engine
+        struct EngineMenuItem : MenuItem {
+            FlowerPatch* flowerPatchModule;
+            int engine;
+            void onAction(const event::Action& e) override {
+                flowerPatchModule->analysisEngine = engine;
+            }
+            void step() override {
+                rightText = (flowerPatchModule->analysisEngine == engine) ? "✔" : "";
+                MenuItem::step();
+            }
+        };
+
+        menu->addChild(new MenuSeparator());
+        menu->addChild(createMenuLabel("Analysis"));
+        std::pair<const char*, int> engineOptions[] = {
+            { "FFT", FlowerPatch::FFT_ENGINE },
+            { "Constant-Q (72 pitch resonators)", FlowerPatch::CONSTANT_Q_ENGINE },
+        };
+        for (const auto& option : engineOptions) {
+            EngineMenuItem* engineItem = new EngineMenuItem();
+            engineItem->text = option.first;
+            engineItem->flowerPatchModule = flowerPatchModule;
+            engineItem->engine = option.second;
+            menu->addChild(engineItem);
+        }
+
+        // Analysis STFT size and overlap (FFT engine)
+        struct FftSizeMenuItem : MenuItem {
+            FlowerPatch* flowerPatchModule;
+            int size;
+            void onAction(const event::Action& e) override {
+                flowerPatchModule->fftSize = size;
+            }
+            void step() override {
+                rightText = (flowerPatchModule->fftSize == size) ? "✔" : "";
+                MenuItem::step();
+            }
+        };
+
+        struct HopMenuItem : MenuItem {
+            FlowerPatch* flowerPatchModule;
+            int division;
+            void onAction(const event::Action& e) override {
+                flowerPatchModule->hopDivision = division;
+            }
+            void step() override {
+                rightText = (flowerPatchModule->hopDivision == division) ? "✔" : "";
+                MenuItem::step();
+            }
+        };
+
+        menu->addChild(new MenuSeparator());
+        menu->addChild(createMenuLabel("FFT Size"));
+        for (int size = FlowerPatch::MIN_FFT_SIZE; size <= FlowerPatch::MAX_FFT_SIZE; size *= 2) {
+            FftSizeMenuItem* sizeItem = new FftSizeMenuItem();
+            sizeItem->text = std::to_string(size);
+            sizeItem->flowerPatchModule = flowerPatchModule;
+            sizeItem->size = size;
+            menu->addChild(sizeItem);
+        }
+
+        menu->addChild(new MenuSeparator());
+        menu->addChild(createMenuLabel("FFT Hop"));
+        std::pair<const char*, int> hopOptions[] = {
+            { "Full frame (no overlap)", 1 },
+            { "1/2 frame", 2 },
+            { "1/4 frame", 4 },
+            { "1/8 frame", 8 },
+        };
+        for (const auto& option : hopOptions) {
+            HopMenuItem* hopItem = new HopMenuItem();
+            hopItem->text = option.first;
+            hopItem->flowerPatchModule = flowerPatchModule;
+            hopItem->division = option.second;
+            menu->addChild(hopItem);
+        }
     }    
     
 };
@@ -12,14 +12,25 @@
 #include "plugin.hpp"
 #include <cmath>
 #include <algorithm>
+#include <atomic>
 #include "FilterGlass.h"
 
+using simd::float_4;
+
 static constexpr int   HAZE_BUF_SIZE      = 8192;   // power-of-2; ~170ms at 48kHz, ~85ms at 96kHz
 static constexpr int   HAZE_BUF_MASK      = HAZE_BUF_SIZE - 1;
 static constexpr float HAZE_BASE_DELAY_MS = 12.f;   // center delay (ms)
 static constexpr float HAZE_DEPTH_MAX_MS  =  8.f;   // max LFO modulation swing (ms)
 static constexpr int   HAZE_VOICES        =  3;
 
+// -----------------------------------------------------------------------------
+// Lane layout
+// Every line in Haze is a float_4: four lines that advance together, stored
+// interleaved one float_4 per slot. Stereo packs voices 0-2 of one channel
+// into lanes 0-2 (lane 3 is a silent spare); poly packs four channels of one
+// voice. The rings live in memory owned by the module.
+// -----------------------------------------------------------------------------
+
 // -----------------------------------------------------------------------------
 // hazeLoopLimit
 // Soft limit on the value entering the delay loop.
@@ -28,46 +39,87 @@ static constexpr float HAZE_LOOP_KNEE = 10.f;
 static constexpr float HAZE_LOOP_CEIL = 14.f;
 static constexpr float HAZE_LOOP_SPAN = 2.f * (HAZE_LOOP_CEIL - HAZE_LOOP_KNEE);
 
-static inline float hazeLoopLimit(float x) {
-    float magnitude = fabsf(x);
-    if (magnitude <= HAZE_LOOP_KNEE) return x;
-    float over = (magnitude - HAZE_LOOP_KNEE) * (1.f / HAZE_LOOP_SPAN);
-    if (over > 1.f) over = 1.f;
-    float limited = HAZE_LOOP_KNEE + HAZE_LOOP_SPAN * (over - 0.5f * over * over);
-    return (x < 0.f) ? -limited : limited;
+static inline float_4 hazeLoopLimit(float_4 x) {
+    float_4 magnitude = simd::fabs(x);
+    float_4 over      = simd::clamp((magnitude - HAZE_LOOP_KNEE) * (1.f / HAZE_LOOP_SPAN), 0.f, 1.f);
+    float_4 limited   = HAZE_LOOP_KNEE + HAZE_LOOP_SPAN * (over - 0.5f * over * over);
+    limited = simd::ifelse(magnitude <= HAZE_LOOP_KNEE, magnitude, limited);
+    return simd::ifelse(x < 0.f, -limited, limited);
+}
+
+// Lagrange 4-point basis, matching glassLagrange. Generic so the same code
+// serves a shared fractional position (float) and per-lane ones (float_4).
+template <typename T>
+static inline void hazeLagrangeWeights(T t, T* w) {
+    w[0] = (-t * (t-1.f) * (t-2.f)) / 6.f;
+    w[1] = ((t+1.f) * (t-1.f) * (t-2.f)) / 2.f;
+    w[2] = (-(t+1.f) * t * (t-2.f)) / 2.f;
+    w[3] = ((t+1.f) * t * (t-1.f)) / 6.f;
 }
 
 // -----------------------------------------------------------------------------
 // HazeDelayLine
-// Ring buffer with Lagrange 4-point fractional read, matching GlassBowl.
+// Four interleaved rings with Lagrange 4-point fractional read, matching
+// GlassBowl. SIZE is a power of 2; the FDN uses a shorter ring than the voices.
 // -----------------------------------------------------------------------------
-struct HazeDelayLine {
-    float buf[HAZE_BUF_SIZE] = {};
-    int   writeIndex = 0;
+template <int SIZE>
+struct HazeDelayLineT {
+    static constexpr int MASK = SIZE - 1;
+    float_4* buf = nullptr;   // SIZE slots
+    int      writeIndex = 0;
 
-    void write(float in) {
+    void write(float_4 in) {
         buf[writeIndex] = in;
-        writeIndex = (writeIndex + 1) & HAZE_BUF_MASK;
+        writeIndex = (writeIndex + 1) & MASK;
     }
 
-    float read(float delaySamples) const {
-        delaySamples = clamp(delaySamples, 1.f, (float)HAZE_BUF_SIZE - 4.f);
+    // All four lanes at the same delay: four vector loads.
+    float_4 read(float delaySamples) const {
+        delaySamples = clamp(delaySamples, 1.f, (float)SIZE - 4.f);
         float rp   = (float)writeIndex - delaySamples;
-        int   base = ((int)floorf(rp)) & HAZE_BUF_MASK;
-        float frac = rp - floorf(rp);
-        float y0   = buf[(base - 1) & HAZE_BUF_MASK];
-        float y1   = buf[base];
-        float y2   = buf[(base + 1) & HAZE_BUF_MASK];
-        float y3   = buf[(base + 2) & HAZE_BUF_MASK];
-        return glassLagrange(y0, y1, y2, y3, frac);
+        int   base = ((int)floorf(rp)) & MASK;
+        float w[4];
+        hazeLagrangeWeights(rp - floorf(rp), w);
+        return w[0] * buf[(base - 1) & MASK]
+             + w[1] * buf[base]
+             + w[2] * buf[(base + 1) & MASK]
+             + w[3] * buf[(base + 2) & MASK];
+    }
+
+    // A delay per lane: the weights stay vector, the taps are gathered.
+    float_4 read(float_4 delaySamples) const {
+        delaySamples = simd::clamp(delaySamples, 1.f, (float)SIZE - 4.f);
+        float_4 rp   = (float)writeIndex - delaySamples;
+        float_4 fl   = simd::floor(rp);
+        float_4 w[4];
+        hazeLagrangeWeights(rp - fl, w);
+        const float* slots = reinterpret_cast<const float*>(buf);
+        float_4 y[4];
+        for (int lane = 0; lane < 4; ++lane) {
+            int base = (int)fl[lane];
+            for (int k = 0; k < 4; ++k)
+                y[k][lane] = slots[((base - 1 + k) & MASK) * 4 + lane];
+        }
+        return w[0] * y[0] + w[1] * y[1] + w[2] * y[2] + w[3] * y[3];
+    }
+
+    // Whole-sample delay per lane, no interpolation.
+    float_4 tap(const int* delayLen) const {
+        const float* slots = reinterpret_cast<const float*>(buf);
+        float_4 y;
+        for (int lane = 0; lane < 4; ++lane)
+            y[lane] = slots[((writeIndex - delayLen[lane]) & MASK) * 4 + lane];
+        return y;
     }
 
     void clear() {
-        std::fill(buf, buf + HAZE_BUF_SIZE, 0.f);
+        std::fill(buf, buf + SIZE, float_4(0.f));
         writeIndex = 0;
     }
 };
 
+typedef HazeDelayLineT<HAZE_BUF_SIZE> HazeDelayLine;
+
 // -----------------------------------------------------------------------------
 // HazeAllpassChain
 // Four cascaded Schroeder allpass sections applied to the voice tap OUTPUT only.
@@ -76,35 +128,38 @@ struct HazeDelayLine {
 // Four stages accumulate ~15ms of group delay spread -- clearly audible as smear.
 //
 // Each voice uses a distinct set of prime delay lengths so the three chains
-// have different diffusion characters.
+// have different diffusion characters. Delay lengths are given per lane.
 //
 //   stage: out    = delayed - g * input
 //          buf[n] = input  + g * delayed
 // -----------------------------------------------------------------------------
 static constexpr int HAZE_AP_STAGES = 4;
+static constexpr int HAZE_AP_SIZE   = 512;   // power of 2, fits all delay lengths below
 
 struct HazeAllpassStage {
-    static constexpr int AP_SIZE = 512;   // power of 2, fits all delay lengths below
-    float buf[AP_SIZE] = {};
-    int   idx = 0;
-
-    float process(float input, int delayLen, float g) {
-        int   readIdx = (idx - delayLen) & (AP_SIZE - 1);
-        float delayed = buf[readIdx];
-        float out     = delayed - g * input;
-        buf[idx]      = (1.f - g * g) * input + g * delayed;  // true Schroeder: buf = x + g*y
-
-        idx           = (idx + 1) & (AP_SIZE - 1);
+    float_4* buf = nullptr;   // HAZE_AP_SIZE slots
+    int      idx = 0;
+
+    float_4 process(float_4 input, const int* delayLen, float g) {
+        const float* slots = reinterpret_cast<const float*>(buf);
+        float_4 delayed;
+        for (int lane = 0; lane < 4; ++lane)
+            delayed[lane] = slots[((idx - delayLen[lane]) & (HAZE_AP_SIZE - 1)) * 4 + lane];
+        float_4 out = delayed - g * input;
+        buf[idx]    = (1.f - g * g) * input + g * delayed;  // true Schroeder: buf = x + g*y
+
+        idx         = (idx + 1) & (HAZE_AP_SIZE - 1);
         return out;
     }
 
-    void clear() { std::fill(buf, buf + AP_SIZE, 0.f); idx = 0; }
+    void clear() { std::fill(buf, buf + HAZE_AP_SIZE, float_4(0.f)); idx = 0; }
 };
 
 struct HazeAllpassChain {
     HazeAllpassStage stage[HAZE_AP_STAGES];
 
-    float process(float x, const int* delays, float g) {
+    // delays[stage][lane]
+    float_4 process(float_4 x, const int (*delays)[4], float g) {
         for (int i = 0; i < HAZE_AP_STAGES; ++i)
             x = stage[i].process(x, delays[i], g);
         return x;
@@ -113,7 +168,7 @@ struct HazeAllpassChain {
     void clear() { for (auto& s : stage) s.clear(); }
 };
 
-// Per-voice delay tables -- prime lengths, all < AP_SIZE=512.
+// Per-voice delay tables -- prime lengths, all < HAZE_AP_SIZE=512.
 // Accumulated group delay at 48kHz:
 //   voice 0: 347+211+113+67 = 738 samples ~ 15.4ms
 //   voice 1: 251+167+ 89+53 = 560 samples ~ 11.7ms
@@ -123,11 +178,212 @@ static constexpr int   HAZE_AP_DELAYS[HAZE_VOICES][HAZE_AP_STAGES] = {
     { 251, 167,  89,  53 },
     { 283, 149, 103,  71 },
 };
+
+// The same table laid out [stage][lane] for the two chain layouts: one voice
+// per lane (stereo, spare lane repeats voice 0) and one voice in all lanes (poly).
+static constexpr int HAZE_AP_DELAYS_STEREO[HAZE_AP_STAGES][4] = {
+    { 347, 251, 283, 347 },
+    { 211, 167, 149, 211 },
+    { 113,  89, 103, 113 },
+    {  67,  53,  71,  67 },
+};
+static constexpr int HAZE_AP_DELAYS_POLY[HAZE_VOICES][HAZE_AP_STAGES][4] = {
+    { { 347, 347, 347, 347 }, { 211, 211, 211, 211 }, { 113, 113, 113, 113 }, {  67,  67,  67,  67 } },
+    { { 251, 251, 251, 251 }, { 167, 167, 167, 167 }, {  89,  89,  89,  89 }, {  53,  53,  53,  53 } },
+    { { 283, 283, 283, 283 }, { 149, 149, 149, 149 }, { 103, 103, 103, 103 }, {  71,  71,  71,  71 } },
+};
+
 // Default allpass coefficient. Exposed in the context menu as hazeApCoeff.
 // Higher = more diffusion, also slightly more energy per stage.
 // The true Schroeder formula keeps |H|=1 regardless of this value.
 static constexpr float HAZE_AP_COEFF_DEFAULT = 0.55f;
 
+// -----------------------------------------------------------------------------
+// HazeFDN
+// Third diffusion mode: a feedback delay network of 4 or 8 lines mixed by an
+// orthonormal Hadamard matrix. It is the multichannel form of the Schroeder
+// stage above, with the matrix-times-delays T in place of a single delay:
+//
+//   d      = U * taps                          U = Hadamard / sqrt(N)
+//   out    = d - g * x                         (per line)
+//   buf[n] = (1 - g*g) * x + g * d
+//
+// giving (T - g)(I - gT)^-1, which is lossless for any g in (0,1). The scalar
+// in/out projections keep |H| <= 1, so the network can sit inside the chorus
+// feedback loop exactly where the allpass chain does. The input is spread
+// over the lines with alternating signs and collected the same way.
+//
+// Lanes are independent (voices in stereo, channels in poly); the matrix
+// runs across lines, so each butterfly is one float_4 add and one subtract.
+// -----------------------------------------------------------------------------
+static constexpr int HAZE_FDN_MAX_LINES = 8;
+static constexpr int HAZE_FDN_SIZE      = 1024;   // power of 2, fits all lengths below
+
+typedef HazeDelayLineT<HAZE_FDN_SIZE> HazeFDNLine;
+
+// Per-voice line lengths -- primes, all < HAZE_FDN_SIZE. Ordered so the
+// 4-line network uses a spread of short and long lines too.
+static constexpr int HAZE_FDN_DELAYS[HAZE_VOICES][HAZE_FDN_MAX_LINES] = {
+    { 127, 443, 271, 647, 199, 541, 353, 761 },
+    { 139, 457, 283, 661, 211, 557, 367, 787 },
+    { 151, 467, 307, 673, 223, 569, 379, 811 },
+};
+
+// HAZE_FDN_DELAYS laid out [line][lane] for the stereo and poly lane layouts,
+// like HAZE_AP_DELAYS_STEREO / _POLY.
+struct HazeFDNDelays {
+    int stereo[HAZE_FDN_MAX_LINES][4];
+    int poly[HAZE_VOICES][HAZE_FDN_MAX_LINES][4];
+
+    HazeFDNDelays() {
+        for (int i = 0; i < HAZE_FDN_MAX_LINES; ++i) {
+            for (int lane = 0; lane < 4; ++lane)
+                stereo[i][lane] = HAZE_FDN_DELAYS[lane < HAZE_VOICES ? lane : 0][i];
+            for (int v = 0; v < HAZE_VOICES; ++v)
+                for (int lane = 0; lane < 4; ++lane)
+                    poly[v][i][lane] = HAZE_FDN_DELAYS[v][i];
+        }
+    }
+
+    static const HazeFDNDelays& get() {
+        static const HazeFDNDelays delays;
+        return delays;
+    }
+};
+
+// In-place fast Walsh-Hadamard transform over n registers, scaled to be
+// orthonormal. n is 4 or 8.
+static inline void hazeHadamard(float_4* y, int n) {
+    for (int h = 1; h < n; h *= 2) {
+        for (int i = 0; i < n; i += 2 * h) {
+            for (int j = i; j < i + h; ++j) {
+                float_4 a = y[j];
+                float_4 b = y[j + h];
+                y[j]     = a + b;
+                y[j + h] = a - b;
+            }
+        }
+    }
+    const float norm = (n == 8) ? 0.35355339f : 0.5f;
+    for (int i = 0; i < n; ++i)
+        y[i] *= norm;
+}
+
+struct HazeFDN {
+    HazeFDNLine line[HAZE_FDN_MAX_LINES];
+
+    // delays[line][lane]; n = 4 or 8 active lines.
+    float_4 process(float_4 x, const int (*delays)[4], int n, float g) {
+        const float norm = (n == 8) ? 0.35355339f : 0.5f;
+        float_4 d[HAZE_FDN_MAX_LINES];
+        for (int i = 0; i < n; ++i)
+            d[i] = line[i].tap(delays[i]);
+        hazeHadamard(d, n);
+
+        float_4 xin = x * norm;
+        float_4 out = 0.f;
+        for (int i = 0; i < n; i += 2) {
+            float_4 o0 = d[i]     - g * xin;
+            float_4 o1 = d[i + 1] + g * xin;
+            line[i].write(    (1.f - g * g) * xin + g * d[i]);
+            line[i + 1].write(-(1.f - g * g) * xin + g * d[i + 1]);
+            out += o0 - o1;
+        }
+        return out * norm;
+    }
+
+    void clear() { for (auto& l : line) l.clear(); }
+};
+
+// GlassDCBlocker, four lanes
+struct HazeDCBlocker4 {
+    float_4 x1 = 0.f, y1 = 0.f;
+    float   R = 0.9995f;
+    void setSampleRate(float sr) {
+        R = rack::clamp(1.f - 2.f * float(M_PI) * 20.f / sr, 0.990f, 0.9999f);
+    }
+    float_4 process(float_4 x) {
+        y1 = x - x1 + R * y1;
+        x1 = x;
+        return y1;
+    }
+    void reset() { x1 = 0.f; y1 = 0.f; }
+};
+
+// GlassADAADrive, four lanes
+struct HazeADAADrive4 {
+    float_4 lastInput = 0.f;
+    float_4 process(float_4 inV) {
+        float_4 norm = simd::clamp(inV / 10.f, -1.f, 1.f);
+        float_4 d    = norm - lastInput;
+        float_4 useADAA = simd::fabs(d) > 1e-6f;
+        float_4 adaa = (antiderivative(norm) - antiderivative(lastInput)) / simd::ifelse(useADAA, d, 1.f);
+        float_4 out  = simd::ifelse(useADAA, adaa, polyTanh(norm));
+        lastInput    = norm;
+        return simd::clamp(out * 6.9f, -10.f, 10.f);
+    }
+    void reset() { lastInput = 0.f; }
+    static float_4 polyTanh(float_4 x) {
+        float_4 x2 = x * x;
+        return x - x * x2 * (1.f/3.f - x2 * (2.f/15.f - 17.f/315.f * x2));
+    }
+    static float_4 antiderivative(float_4 x) {
+        float_4 x2 = x * x;
+        return 0.5f*x2 - (1.f/12.f)*x2*x2 + (1.f/45.f)*x2*x2*x2
+               - (17.f/2520.f)*x2*x2*x2*x2;
+    }
+};
+
+// Stereo core: one line per channel, voices 0-2 in lanes 0-2.
+struct HazeStereoCore {
+    HazeDelayLine    delayL, delayR;
+    HazeAllpassChain apL,    apR;
+    HazeFDN          fdnL,   fdnR;
+    HazeDCBlocker4   dcBlockL, dcBlockR;
+    float_4          lpfZL = 0.f, lpfZR = 0.f;
+};
+
+// One block of the polyphonic engine: four poly channels, every voice and side.
+struct HazePolyBlock {
+    HazeDelayLine    delayL[HAZE_VOICES], delayR[HAZE_VOICES];
+    HazeAllpassChain apL[HAZE_VOICES],    apR[HAZE_VOICES];
+    HazeFDN          fdnL[HAZE_VOICES],   fdnR[HAZE_VOICES];
+    HazeDCBlocker4   dcBlockL[HAZE_VOICES], dcBlockR[HAZE_VOICES];
+    float_4          lpfZL[HAZE_VOICES] = {}, lpfZR[HAZE_VOICES] = {};
+    HazeADAADrive4   saturatorL, saturatorR;
+
+    void reset() {
+        for (int v = 0; v < HAZE_VOICES; ++v) {
+            dcBlockL[v].reset();
+            dcBlockR[v].reset();
+            lpfZL[v] = 0.f;
+            lpfZR[v] = 0.f;
+        }
+        saturatorL.reset();
+        saturatorR.reset();
+    }
+};
+
+// float_4 slots taken by one line, its allpass chain and its FDN
+static constexpr int HAZE_LINE_SLOTS       = HAZE_BUF_SIZE + HAZE_AP_STAGES * HAZE_AP_SIZE
+                                           + HAZE_FDN_MAX_LINES * HAZE_FDN_SIZE;
+static constexpr int HAZE_POLY_BLOCK_SLOTS = 2 * HAZE_VOICES * HAZE_LINE_SLOTS;
+
+// Point a line, its chain and its FDN at the next HAZE_LINE_SLOTS of memory.
+static inline float_4* hazeBindLine(float_4* slot, HazeDelayLine& line, HazeAllpassChain& chain, HazeFDN& fdn) {
+    line.buf = slot;
+    slot += HAZE_BUF_SIZE;
+    for (int i = 0; i < HAZE_AP_STAGES; ++i) {
+        chain.stage[i].buf = slot;
+        slot += HAZE_AP_SIZE;
+    }
+    for (int i = 0; i < HAZE_FDN_MAX_LINES; ++i) {
+        fdn.line[i].buf = slot;
+        slot += HAZE_FDN_SIZE;
+    }
+    return slot;
+}
+
 // -----------------------------------------------------------------------------
 // Forward declaration -- HazeButtonQuantity is defined before Haze but its
 // getLabel() implementation needs Haze to be complete, so it is defined
@@ -183,18 +439,13 @@ struct Haze : Module {
         LIGHTS_LEN
     };
 
-    // 3 independent delay lines per channel -- each voice has its own feedback loop.
-    HazeDelayLine delayL[HAZE_VOICES];
-    HazeDelayLine delayR[HAZE_VOICES];
-
-    // DC blockers on the delay line read output -- one per voice per channel.
-    // Prevents hot-signal DC offset from accumulating inside each feedback loop.
-    GlassDCBlocker dcBlockL[HAZE_VOICES];
-    GlassDCBlocker dcBlockR[HAZE_VOICES];
-
-    // Per-voice one-pole LPF state for tone darkening on the feedback path.
-    float lpfZL[HAZE_VOICES] = {};
-    float lpfZR[HAZE_VOICES] = {};
+    // 3 independent delay lines per channel -- each voice has its own feedback
+    // loop -- packed one voice per lane, so the six lines are two float_4 paths.
+    // Each line carries a DC blocker on its read output (keeps hot-signal DC
+    // from accumulating inside the loop) and one-pole LPF state for tone
+    // darkening on the feedback path.
+    HazeStereoCore stereo;
+    std::vector<float_4> stereoMemory;
 
     // ADAA saturator on the wet output sum -- prevents feedback accumulation from
     // overloading downstream modules.
@@ -211,21 +462,32 @@ struct Haze : Module {
     // The true Schroeder formula keeps |H|=1 at any value in (0,1).
     float hazeApCoeff = HAZE_AP_COEFF_DEFAULT;
 
-    bool allpassMode[3] = {false,false,false};
+    // Per-voice mode: Chorus (direct tap), Diffuse (allpass chain) or FDN.
+    enum VoiceMode { CHORUS_MODE, DIFFUSE_MODE, FDN_MODE, VOICE_MODES_LEN };
+    int voiceMode[HAZE_VOICES] = {CHORUS_MODE, CHORUS_MODE, CHORUS_MODE};
 
-    // Button edge detectors -- toggle allpassMode on press.
+    // Button edge detectors -- cycle voiceMode on press.
     dsp::BooleanTrigger buttonTrigger[HAZE_VOICES];
 
-    // 4-stage allpass diffusion chains, one per voice per channel.
-    // Applied to the tap OUTPUT only -- never feeds back into the delay loop.
-    HazeAllpassChain apL[HAZE_VOICES];
-    HazeAllpassChain apR[HAZE_VOICES];
-
+    // 4-stage allpass diffusion chains (in HazeStereoCore / HazePolyBlock) are
+    // applied to the tap OUTPUT only -- they never feed back into the delay loop.
     // Per-voice crossfade gain for allpass mode (0=direct, 1=full allpass).
     // Linear ramp over ~3ms avoids the click from a hard mode switch.
     // The chain always runs so it stays warm and the transition is seamless.
     float apGain[HAZE_VOICES] = {};
 
+    // Same crossfade for FDN mode. The FDN is the costlier of the two, so it
+    // only runs while some voice uses it; a network that wakes up is cleared
+    // first so it never replays a stale tail. Clearing goes one line per side
+    // per sample, like clearBufferIncrementally in Tri Delay, and the fade-in
+    // holds until it is done. Line count is set via context menu (4 or 8),
+    // saved in patch JSON.
+    float fdnGain[HAZE_VOICES] = {};
+    int   fdnLines       = 8;
+    int   fdnLinesActive = 8;               // engine-side copy
+    int   fdnLinesCleared[HAZE_VOICES] = {}; // poly networks, per voice, across all blocks
+    int   stereoFdnLinesCleared = 0;        // stereo network serves all three voices
+
     // Per-voice LFO sin values -- written by process(), read by step() for LEDs.
     float lfoSinL[HAZE_VOICES] = {};
 
@@ -244,9 +506,32 @@ struct Haze : Module {
     float cachedLpfCoeff     = 0.073f;
     float cachedDepthSamples = 0.f;
 
+    // -- Polyphonic mode -------------------------------------------------------
+    // Each poly channel gets its own voices, four channels to a float_4 block.
+    // All channels share the LFO, so one set of delay times serves every lane.
+    // The rings of all POLY_BLOCKS live in one arena, built on the UI thread
+    // the first time poly mode is enabled and handed to process() through
+    // pendingPolyArena, so the engine never allocates. It is kept until the
+    // module goes away. Leaving poly mode clears it a batch per sample, and
+    // the next entry waits for that to finish so it starts silent.
+    static constexpr int POLY_BLOCKS = 4;
+    static constexpr size_t POLY_ARENA_SLOTS = (size_t)POLY_BLOCKS * HAZE_POLY_BLOCK_SLOTS;
+    static constexpr size_t POLY_CLEAR_BATCH = 2048;  // whole arena in about 5ms at 48kHz
+    bool polyMode   = false;            // set via context menu, saved in patch
+    bool polyActive = false;            // engine-side copy, clears state on entry
+    HazePolyBlock polyBlock[POLY_BLOCKS];
+    float_4* polyArena = nullptr;                       // engine-side
+    std::atomic<float_4*> pendingPolyArena{nullptr};
+    bool polyArenaBuilt = false;                        // UI-side
+    size_t polyClearPos = POLY_ARENA_SLOTS;             // slots cleared since poly mode was left
+
     Haze() {
         config(PARAMS_LEN, INPUTS_LEN, OUTPUTS_LEN, LIGHTS_LEN);
 
+        stereoMemory.assign(2 * HAZE_LINE_SLOTS, float_4(0.f));
+        float_4* slot = hazeBindLine(stereoMemory.data(), stereo.delayL, stereo.apL, stereo.fdnL);
+        hazeBindLine(slot, stereo.delayR, stereo.apR, stereo.fdnR);
+
         configParam(RATE_PARAM,    0.f, 1.f, 0.3f,  "Rate");
         configParam(RATE_ATT,     -1.f, 1.f, 0.f,   "Rate Att.");
         configParam(DEPTH_PARAM,   0.f, 1.f, 0.5f,  "Depth");
@@ -275,8 +560,25 @@ struct Haze : Module {
         configOutput(OUT_R_OUTPUT, "Audio R");
     }
 
+    ~Haze() {
+        delete[] polyArena;
+        delete[] pendingPolyArena.exchange(nullptr);
+    }
+
     void processBypass(const ProcessArgs& args) override {
-        // Note: Does not support polyphony
+        if (polyMode) {
+            int channels = polyChannels();
+            bool rConnected = inputs[IN_R_INPUT].isConnected();
+            for (int c = 0; c < channels; c += 4) {
+                float_4 left  = inputs[IN_L_INPUT].getPolyVoltageSimd<float_4>(c);
+                float_4 right = rConnected ? inputs[IN_R_INPUT].getPolyVoltageSimd<float_4>(c) : left;
+                outputs[OUT_L_OUTPUT].setVoltageSimd(left, c);
+                outputs[OUT_R_OUTPUT].setVoltageSimd(right, c);
+            }
+            outputs[OUT_L_OUTPUT].setChannels(channels);
+            outputs[OUT_R_OUTPUT].setChannels(channels);
+            return;
+        }
         float left = getInput(IN_L_INPUT).getVoltage();
         // Route left input to right output if right input is disconnected
         float right = getInput(IN_R_INPUT).isConnected() ? getInput(IN_R_INPUT).getVoltage() : left;
@@ -284,28 +586,97 @@ struct Haze : Module {
         getOutput(OUT_R_OUTPUT).setVoltage(right);
     }
 
+    int polyChannels() {
+        return std::max(1, std::max(inputs[IN_L_INPUT].getChannels(), inputs[IN_R_INPUT].getChannels()));
+    }
+
+    // Point every block's rings at its slice of the arena.
+    void bindPolyArena() {
+        for (int b = 0; b < POLY_BLOCKS; ++b) {
+            float_4* slot = polyArena + b * HAZE_POLY_BLOCK_SLOTS;
+            for (int v = 0; v < HAZE_VOICES; ++v)
+                slot = hazeBindLine(slot, polyBlock[b].delayL[v], polyBlock[b].apL[v], polyBlock[b].fdnL[v]);
+            for (int v = 0; v < HAZE_VOICES; ++v)
+                slot = hazeBindLine(slot, polyBlock[b].delayR[v], polyBlock[b].apR[v], polyBlock[b].fdnR[v]);
+        }
+    }
+
+    // UI thread: switch poly mode, building the arena the first time it is wanted
+    void setPolyMode(bool enabled) {
+        if (enabled && !polyArenaBuilt) {
+            polyArenaBuilt = true;
+            pendingPolyArena.store(new float_4[POLY_ARENA_SLOTS]());
+        }
+        polyMode = enabled;
+    }
+
+    // Engine thread: follow polyMode. Entry waits until the arena has arrived
+    // and any clearing left over from the last exit is done.
+    void updatePolyActive() {
+        if (!polyArena) {
+            polyArena = pendingPolyArena.exchange(nullptr);
+            if (polyArena) bindPolyArena();
+        }
+        if (polyMode && !polyActive) {
+            if (!polyArena || polyClearPos < POLY_ARENA_SLOTS) return;
+            for (int b = 0; b < POLY_BLOCKS; ++b)
+                polyBlock[b].reset();
+            polyActive = true;
+        } else if (!polyMode && polyActive) {
+            polyActive = false;
+            polyClearPos = 0;
+        }
+    }
+
+    void clearPolyIncrementally() {
+        size_t end = std::min(polyClearPos + POLY_CLEAR_BATCH, POLY_ARENA_SLOTS);
+        std::fill(polyArena + polyClearPos, polyArena + end, float_4(0.f));
+        polyClearPos = end;
+    }
+
+    void clearPoly() {
+        if (polyArena) std::fill(polyArena, polyArena + POLY_ARENA_SLOTS, float_4(0.f));
+        polyClearPos = POLY_ARENA_SLOTS;
+        for (int b = 0; b < POLY_BLOCKS; ++b)
+            polyBlock[b].reset();
+    }
+
+    // Whether the network voice v currently runs on has finished clearing
+    bool fdnCleared(int v) const {
+        return polyActive ? fdnLinesCleared[v] >= POLY_BLOCKS * fdnLinesActive
+                          : stereoFdnLinesCleared >= fdnLinesActive;
+    }
+
     void onReset() override {
+        stereo.delayL.clear();
+        stereo.delayR.clear();
+        stereo.dcBlockL.reset();
+        stereo.dcBlockR.reset();
+        stereo.lpfZL = 0.f;
+        stereo.lpfZR = 0.f;
+        stereo.apL.clear();
+        stereo.apR.clear();
+        stereo.fdnL.clear();
+        stereo.fdnR.clear();
         for (int v = 0; v < HAZE_VOICES; ++v) {
-            delayL[v].clear();
-            delayR[v].clear();
-            dcBlockL[v].reset();
-            dcBlockR[v].reset();
-            lpfZL[v] = 0.f;
-            lpfZR[v] = 0.f;
-            apL[v].clear();
-            apR[v].clear();
-            allpassMode[v] = false;
-            apGain[v]      = 0.f;
+            voiceMode[v] = CHORUS_MODE;
+            apGain[v]    = 0.f;
+            fdnGain[v]   = 0.f;
         }
         saturatorL.reset();
         saturatorR.reset();
+        clearPoly();
         lfoPhase = 0.f;
     }
 
     void onSampleRateChange(const SampleRateChangeEvent& e) override {
+        stereo.dcBlockL.setSampleRate(e.sampleRate);
+        stereo.dcBlockR.setSampleRate(e.sampleRate);
         for (int v = 0; v < HAZE_VOICES; ++v) {
-            dcBlockL[v].setSampleRate(e.sampleRate);
-            dcBlockR[v].setSampleRate(e.sampleRate);
+            for (int b = 0; b < POLY_BLOCKS; ++b) {
+                polyBlock[b].dcBlockL[v].setSampleRate(e.sampleRate);
+                polyBlock[b].dcBlockR[v].setSampleRate(e.sampleRate);
+            }
         }
         srLpfBright = expf(-2.f * float(M_PI) * 20000.f / e.sampleRate);
         srBaseDelay = HAZE_BASE_DELAY_MS * e.sampleRate * 0.001f;
@@ -324,9 +695,14 @@ struct Haze : Module {
         json_object_set_new(root, "hazeCutoffLow",  json_real(hazeCutoffLow));
         json_object_set_new(root, "hazeCutoffHigh", json_real(hazeCutoffHigh));
         json_object_set_new(root, "hazeApCoeff",   json_real(hazeApCoeff));
-        json_object_set_new(root, "allpassMode0",  json_boolean(allpassMode[0]));
-        json_object_set_new(root, "allpassMode1",  json_boolean(allpassMode[1]));
-        json_object_set_new(root, "allpassMode2",  json_boolean(allpassMode[2]));
+        json_object_set_new(root, "allpassMode0",  json_boolean(voiceMode[0] == DIFFUSE_MODE));
+        json_object_set_new(root, "allpassMode1",  json_boolean(voiceMode[1] == DIFFUSE_MODE));
+        json_object_set_new(root, "allpassMode2",  json_boolean(voiceMode[2] == DIFFUSE_MODE));
+        json_object_set_new(root, "voiceMode0",    json_integer(voiceMode[0]));
+        json_object_set_new(root, "voiceMode1",    json_integer(voiceMode[1]));
+        json_object_set_new(root, "voiceMode2",    json_integer(voiceMode[2]));
+        json_object_set_new(root, "fdnLines",      json_integer(fdnLines));
+        json_object_set_new(root, "polyMode",      json_boolean(polyMode));
         return root;
     }
 
@@ -337,15 +713,24 @@ struct Haze : Module {
         if (jh) hazeCutoffHigh = clamp((float)json_number_value(jh), 200.f, 20000.f);
         json_t* jc = json_object_get(root, "hazeApCoeff");
         if (jc) hazeApCoeff = clamp((float)json_number_value(jc), 0.1f, 0.95f);
-        json_t* am0 = json_object_get(root, "allpassMode0");
-        if (am0) allpassMode[0] = json_boolean_value(am0);
-        json_t* am1 = json_object_get(root, "allpassMode1");
-        if (am1) allpassMode[1] = json_boolean_value(am1);
-        json_t* am2 = json_object_get(root, "allpassMode2");
-        if (am2) allpassMode[2] = json_boolean_value(am2);
-        // Snap apGain to match restored state so no fade-in on patch load.
-        for (int v = 0; v < HAZE_VOICES; ++v)
-            apGain[v] = allpassMode[v] ? 1.f : 0.f;
+        // allpassMode* is still written for older versions; voiceMode* wins.
+        static const char* allpassKeys[HAZE_VOICES] = { "allpassMode0", "allpassMode1", "allpassMode2" };
+        static const char* modeKeys[HAZE_VOICES]    = { "voiceMode0",   "voiceMode1",   "voiceMode2" };
+        for (int v = 0; v < HAZE_VOICES; ++v) {
+            json_t* am = json_object_get(root, allpassKeys[v]);
+            if (am) voiceMode[v] = json_boolean_value(am) ? DIFFUSE_MODE : CHORUS_MODE;
+            json_t* vm = json_object_get(root, modeKeys[v]);
+            if (vm) voiceMode[v] = clamp((int)json_integer_value(vm), 0, VOICE_MODES_LEN - 1);
+        }
+        json_t* fl = json_object_get(root, "fdnLines");
+        if (fl) fdnLines = (json_integer_value(fl) == 4) ? 4 : 8;
+        json_t* pm = json_object_get(root, "polyMode");
+        if (pm) setPolyMode(json_boolean_value(pm));
+        // Snap gains to match restored state so no fade-in on patch load.
+        for (int v = 0; v < HAZE_VOICES; ++v) {
+            apGain[v]  = (voiceMode[v] == DIFFUSE_MODE) ? 1.f : 0.f;
+            fdnGain[v] = (voiceMode[v] == FDN_MODE)     ? 1.f : 0.f;
+        }
     }
 
     void process(const ProcessArgs& args) override {
@@ -373,12 +758,6 @@ struct Haze : Module {
             cachedDepthSamples = depthNorm * depthNorm * HAZE_DEPTH_MAX_MS * sr * 0.001f;
         }
 
-        // -- Inputs -------------------------------------------------------------
-        float inL = inputs[IN_L_INPUT].getVoltage();
-        float inR = inputs[IN_R_INPUT].isConnected() ? inputs[IN_R_INPUT].getVoltage() : inL;
-        inL *= density * gain;
-        inR *= density * gain;
-
         // -- LFO advance --------------------------------------------------------
         lfoPhase += cachedRateHz / args.sampleRate;
         if (lfoPhase >= 1.f) lfoPhase -= 1.f;
@@ -386,7 +765,26 @@ struct Haze : Module {
         // -- Button toggles -----------------------------------------------------
         for (int v = 0; v < HAZE_VOICES; ++v) {
             if (buttonTrigger[v].process(params[BUTTON_PARAM_0 + v].getValue() > 0.5f))
-                allpassMode[v] = !allpassMode[v];
+                voiceMode[v] = (voiceMode[v] + 1) % VOICE_MODES_LEN;
+
+            // Linear 3ms crossfade toward the target gains.
+            float apTarget = (voiceMode[v] == DIFFUSE_MODE) ? 1.f : 0.f;
+            if (apGain[v] < apTarget) apGain[v] = std::min(apGain[v] + srApStep, apTarget);
+            else                      apGain[v] = std::max(apGain[v] - srApStep, apTarget);
+            float fdnTarget = (voiceMode[v] == FDN_MODE) ? 1.f : 0.f;
+            if (fdnGain[v] < fdnTarget) {
+                if (fdnCleared(v)) fdnGain[v] = std::min(fdnGain[v] + srApStep, fdnTarget);
+            } else {
+                fdnGain[v] = std::max(fdnGain[v] - srApStep, fdnTarget);
+            }
+        }
+
+        // A size change wakes every network afresh.
+        if (fdnLines != fdnLinesActive) {
+            fdnLinesActive = fdnLines;
+            stereoFdnLinesCleared = 0;
+            for (int v = 0; v < HAZE_VOICES; ++v)
+                fdnLinesCleared[v] = 0;
         }
 
         // -- LFO sines: 2 trig calls, all 6 values derived by identity ----------
@@ -399,60 +797,92 @@ struct Haze : Module {
         const float sinLv[3] = { s,  (sc3 - s) * 0.5f,  -(s + sc3) * 0.5f };
         const float sinRv[3] = { -sinLv[2], -sinLv[0], -sinLv[1] };
 
+        // Store for step() -- LEDs are updated at frame rate, not audio rate.
+        for (int v = 0; v < HAZE_VOICES; ++v)
+            lfoSinL[v] = sinLv[v];
 
-        // -- Three independent chorus voices per channel -------------------------
-        float wetL = 0.f, wetR = 0.f;
-
-        for (int v = 0; v < HAZE_VOICES; ++v) {
-            float sinL = sinLv[v];
-            float sinR = sinRv[v];
-
-            float delayTimeL = srBaseDelay + sinL * cachedDepthSamples;
-            float delayTimeR = srBaseDelay + sinR * cachedDepthSamples;
-
-            float outL = delayL[v].read(delayTimeL);
-            float outR = delayR[v].read(delayTimeR);
-
-            // DC block the delay output before it re-enters the feedback loop.
-            outL = dcBlockL[v].process(outL);
-            outR = dcBlockR[v].process(outR);
-
-            // One-pole LPF for tone darkening -- lpfCoeff=0 is transparent.
-            lpfZL[v] = (1.f - cachedLpfCoeff) * outL + cachedLpfCoeff * lpfZL[v];
-            lpfZR[v] = (1.f - cachedLpfCoeff) * outR + cachedLpfCoeff * lpfZR[v];
-            outL = lpfZL[v];
-            outR = lpfZR[v];
-
-            // Linear 3ms crossfade toward the target gain.
-            float apTarget = allpassMode[v] ? 1.f : 0.f;
-            if (apGain[v] < apTarget) apGain[v] = std::min(apGain[v] + srApStep, apTarget);
-            else                      apGain[v] = std::max(apGain[v] - srApStep, apTarget);
-
-            // Adjust feedback a bit lower in allpass mode
-            float feedback = cachedFeedback;
-            if (allpassMode[v]){ feedback *= 0.95f;}
-
-            float apOutL = apL[v].process(outL, HAZE_AP_DELAYS[v], hazeApCoeff);
-            float apOutR = apR[v].process(outR, HAZE_AP_DELAYS[v], hazeApCoeff);
-
-            // Crossfade feedback path.
-            float fbL = outL + apGain[v] * (apOutL - outL);
-            float fbR = outR + apGain[v] * (apOutR - outR);
+        //density 0.2 .. 2.0
+        float correction = 1.f/density;
+        float correctionClamped = clamp(correction, 0.5f, 1.5f);
 
-            // Soft limit
-            delayL[v].write(hazeLoopLimit(inL + cachedFeedback * fbL));
-            delayR[v].write(hazeLoopLimit(inR + cachedFeedback * fbR));
+        if (polyMode != polyActive)
+            updatePolyActive();
+        if (polyClearPos < POLY_ARENA_SLOTS)
+            clearPolyIncrementally();
+        if (polyActive) {
+            processPoly(density * gain, mixNorm, correction, correctionClamped, sinLv, sinRv);
+            return;
+        }
 
-            // Output follows the same signal entering feedback.
-            outL = fbL;
-            outR = fbR;
+        // -- Inputs -------------------------------------------------------------
+        float inL = inputs[IN_L_INPUT].getVoltage();
+        float inR = inputs[IN_R_INPUT].isConnected() ? inputs[IN_R_INPUT].getVoltage() : inL;
+        inL *= density * gain;
+        inR *= density * gain;
+        outputs[OUT_L_OUTPUT].setChannels(1);
+        outputs[OUT_R_OUTPUT].setChannels(1);
+
+        // -- Three independent chorus voices per channel, one per lane ----------
+        // Lane 3 is a spare: it reads at the base delay, is fed silence and is
+        // left out of the wet sum.
+        const float_4 inLv(inL, inL, inL, 0.f);
+        const float_4 inRv(inR, inR, inR, 0.f);
+        const float_4 sinL4(sinLv[0], sinLv[1], sinLv[2], 0.f);
+        const float_4 sinR4(sinRv[0], sinRv[1], sinRv[2], 0.f);
+        const float_4 apGain4(apGain[0], apGain[1], apGain[2], 0.f);
+
+        float_4 outL = stereo.delayL.read(srBaseDelay + sinL4 * cachedDepthSamples);
+        float_4 outR = stereo.delayR.read(srBaseDelay + sinR4 * cachedDepthSamples);
+
+        // DC block the delay output before it re-enters the feedback loop.
+        outL = stereo.dcBlockL.process(outL);
+        outR = stereo.dcBlockR.process(outR);
+
+        // One-pole LPF for tone darkening -- lpfCoeff=0 is transparent.
+        stereo.lpfZL = (1.f - cachedLpfCoeff) * outL + cachedLpfCoeff * stereo.lpfZL;
+        stereo.lpfZR = (1.f - cachedLpfCoeff) * outR + cachedLpfCoeff * stereo.lpfZR;
+        outL = stereo.lpfZL;
+        outR = stereo.lpfZR;
+
+        float_4 apOutL = stereo.apL.process(outL, HAZE_AP_DELAYS_STEREO, hazeApCoeff);
+        float_4 apOutR = stereo.apR.process(outR, HAZE_AP_DELAYS_STEREO, hazeApCoeff);
+
+        // Crossfade feedback path.
+        float_4 fbL = outL + apGain4 * (apOutL - outL);
+        float_4 fbR = outR + apGain4 * (apOutR - outR);
+
+        // FDN voices crossfade in the same way. While a waking network is
+        // still being cleared it stands in as silence, as an empty one would.
+        bool fdnWanted = false;
+        for (int v = 0; v < HAZE_VOICES; ++v)
+            fdnWanted |= fdnGain[v] > 0.f || voiceMode[v] == FDN_MODE;
+        if (fdnWanted) {
+            const float_4 fdnGain4(fdnGain[0], fdnGain[1], fdnGain[2], 0.f);
+            float_4 fdnOutL = 0.f, fdnOutR = 0.f;
+            if (stereoFdnLinesCleared < fdnLinesActive) {
+                stereo.fdnL.line[stereoFdnLinesCleared].clear();
+                stereo.fdnR.line[stereoFdnLinesCleared].clear();
+                ++stereoFdnLinesCleared;
+            } else {
+                const auto& fdnDelays = HazeFDNDelays::get().stereo;
+                fdnOutL = stereo.fdnL.process(outL, fdnDelays, fdnLinesActive, hazeApCoeff);
+                fdnOutR = stereo.fdnR.process(outR, fdnDelays, fdnLinesActive, hazeApCoeff);
+            }
+            fbL += fdnGain4 * (fdnOutL - outL);
+            fbR += fdnGain4 * (fdnOutR - outR);
+        } else {
+            stereoFdnLinesCleared = 0;
+        }
+        for (int v = 0; v < HAZE_VOICES; ++v)
+            fdnLinesCleared[v] = 0;
 
-            wetL += outL;
-            wetR += outR;
+        // Soft limit
+        stereo.delayL.write(hazeLoopLimit(inLv + cachedFeedback * fbL));
+        stereo.delayR.write(hazeLoopLimit(inRv + cachedFeedback * fbR));
 
-            // Store for step() -- LEDs are updated at frame rate, not audio rate.
-            lfoSinL[v] = sinL;
-        }
+        // Output follows the same signal entering feedback.
+        float wetL = fbL[0] + fbL[1] + fbL[2];
+        float wetR = fbR[0] + fbR[1] + fbR[2];
 
         wetL *= (1.f / HAZE_VOICES);
         wetR *= (1.f / HAZE_VOICES);
@@ -465,25 +895,108 @@ struct Haze : Module {
         float satWetR = saturatorR.process(wetR) * satCompensation;
 
         // -- Dry/wet blend ------------------------------------------------------
-        //density 0.2 .. 2.0
-        float correction = 1.f/density;
-        float correctionClamped = clamp(correction, 0.5f, 1.5f);
-
         outputs[OUT_L_OUTPUT].setVoltage((inL * (1.f - mixNorm)* correction + satWetL * mixNorm * correctionClamped));
         outputs[OUT_R_OUTPUT].setVoltage((inR * (1.f - mixNorm)* correction + satWetR * mixNorm * correctionClamped));
     }
+
+    // Same signal flow as the stereo path, four poly channels per pass. Delay
+    // times, LPF coefficient and allpass gains are shared by every lane, so the
+    // Lagrange weights are computed once per voice and side per sample.
+    void processPoly(float inGain, float mixNorm, float correction, float correctionClamped,
+                     const float* sinLv, const float* sinRv) {
+        int channels = polyChannels();
+        bool rConnected = inputs[IN_R_INPUT].isConnected();
+
+        float delayTimeL[HAZE_VOICES], delayTimeR[HAZE_VOICES];
+        for (int v = 0; v < HAZE_VOICES; ++v) {
+            delayTimeL[v] = srBaseDelay + sinLv[v] * cachedDepthSamples;
+            delayTimeR[v] = srBaseDelay + sinRv[v] * cachedDepthSamples;
+        }
+        const float satCompensation = 10.f / 6.9f;
+
+        // A waking network clears one line per side per sample, walking every
+        // block, and reads as silence until it is done.
+        bool fdnWanted[HAZE_VOICES], fdnRunning[HAZE_VOICES];
+        for (int v = 0; v < HAZE_VOICES; ++v) {
+            fdnWanted[v] = fdnGain[v] > 0.f || voiceMode[v] == FDN_MODE;
+            fdnRunning[v] = fdnWanted[v] && fdnCleared(v);
+            if (!fdnWanted[v]) {
+                fdnLinesCleared[v] = 0;
+            } else if (!fdnRunning[v]) {
+                int b = fdnLinesCleared[v] / fdnLinesActive;
+                int line = fdnLinesCleared[v] % fdnLinesActive;
+                polyBlock[b].fdnL[v].line[line].clear();
+                polyBlock[b].fdnR[v].line[line].clear();
+                ++fdnLinesCleared[v];
+            }
+        }
+        stereoFdnLinesCleared = 0;
+        const auto& fdnDelays = HazeFDNDelays::get().poly;
+
+        for (int c = 0; c < channels; c += 4) {
+            HazePolyBlock& blk = polyBlock[c / 4];
+
+            float_4 inL = inputs[IN_L_INPUT].getPolyVoltageSimd<float_4>(c);
+            float_4 inR = rConnected ? inputs[IN_R_INPUT].getPolyVoltageSimd<float_4>(c) : inL;
+            inL *= inGain;
+            inR *= inGain;
+
+            float_4 wetL = 0.f, wetR = 0.f;
+            for (int v = 0; v < HAZE_VOICES; ++v) {
+                float_4 outL = blk.dcBlockL[v].process(blk.delayL[v].read(delayTimeL[v]));
+                float_4 outR = blk.dcBlockR[v].process(blk.delayR[v].read(delayTimeR[v]));
+
+                blk.lpfZL[v] = (1.f - cachedLpfCoeff) * outL + cachedLpfCoeff * blk.lpfZL[v];
+                blk.lpfZR[v] = (1.f - cachedLpfCoeff) * outR + cachedLpfCoeff * blk.lpfZR[v];
+                outL = blk.lpfZL[v];
+                outR = blk.lpfZR[v];
+
+                float_4 apOutL = blk.apL[v].process(outL, HAZE_AP_DELAYS_POLY[v], hazeApCoeff);
+                float_4 apOutR = blk.apR[v].process(outR, HAZE_AP_DELAYS_POLY[v], hazeApCoeff);
+                float_4 fbL = outL + apGain[v] * (apOutL - outL);
+                float_4 fbR = outR + apGain[v] * (apOutR - outR);
+                if (fdnRunning[v]) {
+                    float_4 fdnOutL = blk.fdnL[v].process(outL, fdnDelays[v], fdnLinesActive, hazeApCoeff);
+                    float_4 fdnOutR = blk.fdnR[v].process(outR, fdnDelays[v], fdnLinesActive, hazeApCoeff);
+                    fbL += fdnGain[v] * (fdnOutL - outL);
+                    fbR += fdnGain[v] * (fdnOutR - outR);
+                } else if (fdnWanted[v]) {
+                    fbL -= fdnGain[v] * outL;
+                    fbR -= fdnGain[v] * outR;
+                }
+
+                blk.delayL[v].write(hazeLoopLimit(inL + cachedFeedback * fbL));
+                blk.delayR[v].write(hazeLoopLimit(inR + cachedFeedback * fbR));
+
+                wetL += fbL;
+                wetR += fbR;
+            }
+            wetL *= (1.f / HAZE_VOICES);
+            wetR *= (1.f / HAZE_VOICES);
+
+            float_4 satWetL = blk.saturatorL.process(wetL) * satCompensation;
+            float_4 satWetR = blk.saturatorR.process(wetR) * satCompensation;
+
+            outputs[OUT_L_OUTPUT].setVoltageSimd(inL * (1.f - mixNorm) * correction + satWetL * mixNorm * correctionClamped, c);
+            outputs[OUT_R_OUTPUT].setVoltageSimd(inR * (1.f - mixNorm) * correction + satWetR * mixNorm * correctionClamped, c);
+        }
+        outputs[OUT_L_OUTPUT].setChannels(channels);
+        outputs[OUT_R_OUTPUT].setChannels(channels);
+    }
 };
 
 // -----------------------------------------------------------------------------
 // HazeButtonQuantity::getLabel() -- defined here so Haze is complete.
-// Tooltip reads "Node I: Chorus" or "Node I: Diffuse" depending on live state.
+// Tooltip reads "Node I: Chorus", "Node I: Diffuse" or "Node I: FDN"
+// depending on live state.
 // -----------------------------------------------------------------------------
 std::string HazeButtonQuantity::getLabel() {
     Haze* m = dynamic_cast<Haze*>(this->module);
     if (!m) return name;
     static const char* labels[] = { "Node I", "Node II", "Node III" };
+    static const char* modeLabels[] = { ": Chorus", ": Diffuse", ": FDN" };
     return std::string(labels[voiceIdx])
-         + (m->allpassMode[voiceIdx] ? ": Diffuse" : ": Chorus");
+         + modeLabels[m->voiceMode[voiceIdx]];
 }
 
 // -----------------------------------------------------------------------------
@@ -656,16 +1169,21 @@ struct HazeWidget : ModuleWidget {
         for (int v = 0; v < HAZE_VOICES; ++v) {
             float pos = clamp( module->lfoSinL[v], 0.f, 1.f);
             float neg = clamp(-module->lfoSinL[v], 0.f, 1.f);
-            if (!module->allpassMode[v]) {
+            if (module->voiceMode[v] == Haze::CHORUS_MODE) {
                 // Chorus: Blue <-> Yellow
                 module->lights[Haze::LED0_R + v * 3].setBrightness(neg);
                 module->lights[Haze::LED0_G + v * 3].setBrightness(neg);
                 module->lights[Haze::LED0_B + v * 3].setBrightness(pos);
-            } else {
+            } else if (module->voiceMode[v] == Haze::DIFFUSE_MODE) {
                 // Diffuse: Purple <-> Green
                 module->lights[Haze::LED0_R + v * 3].setBrightness(pos);
                 module->lights[Haze::LED0_G + v * 3].setBrightness(neg);
                 module->lights[Haze::LED0_B + v * 3].setBrightness(pos);
+            } else {
+                // FDN: Red <-> Cyan
+                module->lights[Haze::LED0_R + v * 3].setBrightness(pos);
+                module->lights[Haze::LED0_G + v * 3].setBrightness(neg);
+                module->lights[Haze::LED0_B + v * 3].setBrightness(neg);
             }
         }
         ModuleWidget::step();
@@ -679,8 +1197,47 @@ struct HazeWidget : ModuleWidget {
         menu->addChild(createMenuLabel("Haze cutoff @ 100%"));
         menu->addChild(new HazeCutoffLowSlider(module));
         menu->addChild(new MenuSeparator);
-        menu->addChild(createMenuLabel("Diffuse mode coefficient"));
+        menu->addChild(createMenuLabel("Diffuse / FDN mode coefficient"));
         menu->addChild(new HazeApCoeffSlider(module));
+
+        struct FdnLinesItem : MenuItem {
+            Haze* module;
+            int lines;
+            void onAction(const event::Action& e) override {
+                module->fdnLines = lines;
+            }
+            void step() override {
+                rightText = (module->fdnLines == lines) ? "✔" : "";
+                MenuItem::step();
+            }
+        };
+        menu->addChild(new MenuSeparator);
+        menu->addChild(createMenuLabel("FDN mode size"));
+        std::pair<const char*, int> fdnOptions[] = {
+            { "4 lines (4x4 Hadamard)", 4 },
+            { "8 lines (8x8 Hadamard)", 8 },
+        };
+        for (const auto& option : fdnOptions) {
+            FdnLinesItem* item = createMenuItem<FdnLinesItem>(option.first);
+            item->module = module;
+            item->lines  = option.second;
+            menu->addChild(item);
+        }
+
+        struct PolyModeItem : MenuItem {
+            Haze* module;
+            void onAction(const event::Action& e) override {
+                module->setPolyMode(!module->polyMode);
+            }
+            void step() override {
+                rightText = module->polyMode ? "✔" : "";
+                MenuItem::step();
+            }
+        };
+        menu->addChild(new MenuSeparator);
+        PolyModeItem* polyItem = createMenuItem<PolyModeItem>("Polyphonic (voices per channel)");
+        polyItem->module = module;
+        menu->addChild(polyItem);
     }
 };
 Model* modelHaze = createModel<Haze, HazeWidget>("Haze");
\ No newline at end of file
@@ -70,7 +70,7 @@ struct ImpulseController : Module {
     
     // Define an array to store time variables
     float lag[MAX_NODES] = {0.0f}; // Time interval for each light group
-    float groupElapsedTime[MAX_NODES] = {}; // Elapsed time since the last activation for each light group
+    float lagShape[MAX_NODES] = {0.0f}; // Power-scale position of each node between lag[0] and lag[23]
 
     float accumulatedTime = 0.0f; // Accumulator for elapsed time, now an instance variable
 
@@ -117,7 +117,7 @@ struct ImpulseController : Module {
 
     float lightGroupVals[LIGHTS_LEN] = {0.0f}; //array to store light values, where we can update then in draw
 
-    //Define the node-connected graph structure        
+    //Define the node-connected graph structure (compiled into the CSR arrays below)
     const std::map<int, std::vector<int>> nodeConnections = {
         {0, {1}},
         {1, {2, 3}},
@@ -135,6 +135,35 @@ struct ImpulseController : Module {
         {13, {22}},
         {14, {23}}
     };
+
+    // Graph and light groups as contiguous (CSR) arrays: the children of
+    // node n are childNodes[childStart[n] .. childStart[n + 1]) and its
+    // lights are groupLights[lightStart[n] .. lightStart[n + 1]), the OUT
+    // light first.
+    int childStart[MAX_NODES + 1] = {};
+    int childNodes[MAX_NODES] = {};
+    int lightStart[MAX_NODES + 1] = {};
+    LightId groupLights[LIGHTS_LEN] = {};
+
+    // Propagation is event driven. An activated node waits in a min-heap
+    // keyed by the tick at which its lag has run out; it is then armed and
+    // fires into its children once its output falls below the threshold.
+    // Only live nodes (active, or still decaying) are touched per tick.
+    struct PendingActivation {
+        uint32_t due;
+        int node;
+        bool operator<(const PendingActivation& other) const { return due > other.due; }  // min-heap
+    };
+    PendingActivation pending[MAX_NODES];
+    int pendingCount = 0;
+    int armedNodes[MAX_NODES];           // kept in ascending node order
+    int armedCount = 0;
+    int liveNodes[MAX_NODES];
+    int liveCount = 0;
+    bool liveNode[MAX_NODES] = {};
+    uint32_t tick = 0;                   // count of 44.1 kHz-equivalent updates
+    uint32_t activationTick[MAX_NODES] = {};
+    float scheduledLag[2] = {-1.0f, -1.0f}; // lag[0] and lag[23] the queue was keyed with
     
     ImpulseController() {
         config(PARAMS_LEN, INPUTS_LEN, OUTPUTS_LEN, LIGHTS_LEN);
@@ -156,6 +185,89 @@ struct ImpulseController : Module {
         for (int i = 0; i < MAX_NODES; ++i) {
             configOutput(_01_OUTPUT + i, "Impulse " + std::to_string(i+1));
         }
+
+        // Scaling factor for the power scale
+        float scalingFactor =  1.0f; // Adjust this to tune the scaling curve
+        for (int i = 1; i < MAX_NODES-1; i++) {
+            lagShape[i] = powf(i / 23.0f, scalingFactor);
+        }
+
+        compileGraph();
+    }
+
+    void compileGraph() {
+        int edges = 0;
+        int lightCount = 0;
+        for (int node = 0; node < MAX_NODES; ++node) {
+            childStart[node] = edges;
+            auto it = nodeConnections.find(node);
+            if (it != nodeConnections.end()) {
+                for (int child : it->second) childNodes[edges++] = child;
+            }
+            lightStart[node] = lightCount;
+            for (LightId light : lightGroups[node]) groupLights[lightCount++] = light;
+        }
+        childStart[MAX_NODES] = edges;
+        lightStart[MAX_NODES] = lightCount;
+    }
+
+    // First tick at which the node's elapsed time exceeds 0.8 * lag; the
+    // activation tick itself counts as one update
+    uint32_t dueTick(int node, float baseSampleTime) const {
+        return activationTick[node] + (uint32_t)(0.8f * lag[node] / baseSampleTime);
+    }
+
+    void schedule(int node, uint32_t due) {
+        pending[pendingCount++] = {due, node};
+        std::push_heap(pending, pending + pendingCount);
+    }
+
+    // Remove a node from the queue or armed list (retrigger of an active node)
+    void unschedule(int node) {
+        for (int i = 0; i < armedCount; ++i) {
+            if (armedNodes[i] == node) {
+                removeArmed(i);
+                return;
+            }
+        }
+        for (int i = 0; i < pendingCount; ++i) {
+            if (pending[i].node == node) {
+                pending[i] = pending[--pendingCount];
+                std::make_heap(pending, pending + pendingCount);
+                return;
+            }
+        }
+    }
+
+    // Children always have higher indices than their parents, so keeping
+    // the armed list in node order lets a parent see its child still active
+    // when both fire on the same tick, and so does not retrigger it
+    void insertArmed(int node) {
+        int i = armedCount++;
+        while (i > 0 && armedNodes[i - 1] > node) {
+            armedNodes[i] = armedNodes[i - 1];
+            --i;
+        }
+        armedNodes[i] = node;
+    }
+
+    void removeArmed(int index) {
+        for (int i = index + 1; i < armedCount; ++i) armedNodes[i - 1] = armedNodes[i];
+        --armedCount;
+    }
+
+    void activateNode(int node, float baseSampleTime) {
+        if (activeNodes[node]) unschedule(node);
+        activeNodes[node] = true;
+        activationTick[node] = tick;
+        for (int i = lightStart[node]; i < lightStart[node + 1]; ++i) {
+            lightGroupVals[groupLights[i]] = 1.0f; // Turn on all lights for the node's group
+        }
+        if (!liveNode[node]) {
+            liveNode[node] = true;
+            liveNodes[liveCount++] = node;
+        }
+        schedule(node, dueTick(node, baseSampleTime));
     }
 
     void process(const ProcessArgs& args) override {
@@ -201,13 +313,9 @@ struct ImpulseController : Module {
             
             lag[MAX_NODES-1] = 1.2f*spread * lag[0] + 1.2f*lag[0];
             
-            // Scaling factor for the power scale
-            float scalingFactor =  1.0f; // Adjust this to tune the scaling curve
-            
             // Interpolate lag[1] to lag[22] using a power scale
             for (int i = 1; i < MAX_NODES-1; i++) {
-                float factor = powf(i / 23.0f, scalingFactor);
-                lag[i] = lag[0] + (lag[MAX_NODES-1] - lag[0]) * factor;
+                lag[i] = lag[0] + (lag[MAX_NODES-1] - lag[0]) * lagShape[i];
             }
             
             //Set threshold to drop to before propagating to the next node, based on the spread input        
@@ -223,11 +331,7 @@ struct ImpulseController : Module {
             bool manualTriggerPressed = params[TRIGGER_BUTTON].getValue() > 0.0f;
             bool currentInputState = (inputs[_00_INPUT].isConnected() && inputs[_00_INPUT].getVoltage() > 1.0f) || manualTriggerPressed;
             if (currentInputState && !previousInputState && outputs[_01_OUTPUT].getVoltage() <= propagate_thresh) {
-                activeNodes[0] = true; // Activate node 0
-                groupElapsedTime[0] = 0.f; // Reset elapsed time for node 0
-                for (LightId light : lightGroups[0]) {
-                    lightGroupVals[light] = 1.0f; // Turn on all lights for the child node's group
-                }
+                activateNode(0, baseSampleTime); // Activate node 0
             }
             previousInputState = currentInputState;
 
@@ -241,40 +345,47 @@ struct ImpulseController : Module {
                 lightGroupVals[_00OUT_LIGHT] = clamp(brightness, 0.f, 1.f);
             }
 
-            // Activate and Deactivate Nodes, Activate Child Nodes
-            // Iterate over all possible nodes
-            for (int node = 0; node < MAX_NODES; ++node) { 
-                // Check if the node is active
-                if (activeNodes[node]) {
-                    // Increment the elapsed time for each active node
-                    groupElapsedTime[node] += baseSampleTime;  // This ensures the elapsed time is updated every cycle
-
-                    // Check if the output voltage is below the propagation threshold
-                    if (outputs[_01_OUTPUT + node].getVoltage() < propagate_thresh && groupElapsedTime[node]>0.8*lag[node]) {
-                        activeNodes[node] = false;
-                        // Check and activate child nodes if they are considered inactive
-                        if (nodeConnections.count(node) > 0) { // Ensure the node has connections defined
-                            for (int childNode : nodeConnections.at(node)) { 
-                                // Check if the child node is inactive 
-                                if (!activeNodes[childNode] ) { 
-                                    activeNodes[childNode] = true;         // Activate the child node
-                                    groupElapsedTime[childNode] = 0.f;     // Reset the child node's elapsed time                                
-                                    for (LightId light : lightGroups[childNode]) {
-                                        lightGroupVals[light] = 1.0f; // Turn on all lights for the child node's group                                        
-                                    }
-                                } 
-                            }
+            // Re-key the queue when the lags change, so a shorter lag lets
+            // waiting nodes fire earlier just as a longer one holds them back
+            if (lag[0] != scheduledLag[0] || lag[MAX_NODES-1] != scheduledLag[1]) {
+                scheduledLag[0] = lag[0];
+                scheduledLag[1] = lag[MAX_NODES-1];
+                for (int i = 0; i < pendingCount; ++i) {
+                    pending[i].due = dueTick(pending[i].node, baseSampleTime);
+                }
+                std::make_heap(pending, pending + pendingCount);
+            }
+
+            // Nodes whose lag has run out become armed
+            while (pendingCount > 0 && pending[0].due <= tick) {
+                std::pop_heap(pending, pending + pendingCount);
+                insertArmed(pending[--pendingCount].node);
+            }
+
+            // Armed nodes deactivate once their output drops below the
+            // propagation threshold, and activate their inactive children
+            for (int i = 0; i < armedCount; ) {
+                int node = armedNodes[i];
+                if (outputs[_01_OUTPUT + node].getVoltage() < propagate_thresh) {
+                    activeNodes[node] = false;
+                    removeArmed(i);
+                    for (int c = childStart[node]; c < childStart[node + 1]; ++c) {
+                        if (!activeNodes[childNodes[c]]) {
+                            activateNode(childNodes[c], baseSampleTime);
                         }
                     }
+                } else {
+                    ++i;
                 }
             }
 
             float slewRate = 0.1f;
-            // Map OUT light brightness to OUTPUT voltages
-            for (int i = 0; i < MAX_NODES; ++i) {
-                // Directly map the light brightness to output voltage
-                float brightness = lightGroupVals[lightGroups[i][0]]; // Get the brightness of the corresponding light
-                float current_out = outputs[_01_OUTPUT + i].getVoltage(); // Get the voltage of the current output
+            for (int i = 0; i < liveCount; ) {
+                int node = liveNodes[i];
+
+                // Map OUT light brightness to OUTPUT voltages
+                float brightness = lightGroupVals[groupLights[lightStart[node]]]; // Get the brightness of the corresponding light
+                float current_out = outputs[_01_OUTPUT + node].getVoltage(); // Get the voltage of the current output
                 float difference = (brightness * 10.0f) - current_out;
                 float voltageChange = difference;
    
@@ -283,31 +394,39 @@ struct ImpulseController : Module {
                      voltageChange = fmin(difference, slewRate);
                 }                
                 
-                ImpulseOutput[i]=current_out + voltageChange;
-                nextChunk[i]=ImpulseOutput[i]-current_out;
-            }
+                ImpulseOutput[node]=current_out + voltageChange;
+                nextChunk[node]=ImpulseOutput[node]-current_out;
 
-            // Dim lights slowly for each light group
-            for (int groupIndex = 0; groupIndex < int(lightGroups.size()); ++groupIndex) {
-                // Calculate the dimming factor for the current group
-                float dimmingFactor = decay + (1.0f-decay)*2*(lag[groupIndex]);
+                // Dim lights slowly for the light group
+                float dimmingFactor = decay + (1.0f-decay)*2*(lag[node]);
                 dimmingFactor = clamp(dimmingFactor,0.0f,0.99993f);
+                for (int l = lightStart[node]; l < lightStart[node + 1]; ++l) {
+                    lightGroupVals[groupLights[l]] *= dimmingFactor;
+                }
 
-                // Apply the dimming factor to each light within the current group
-                for (LightId lightId : lightGroups[groupIndex]) {
-                    float how_bright = lightGroupVals[lightId];
-                    how_bright *= dimmingFactor; 
-                    lightGroupVals[lightId] = how_bright;                                                           
+                // Retire the envelope once it is inactive, dark and its output has reached 0
+                if (!activeNodes[node] && brightness < 1e-6f && current_out == 0.0f) {
+                    for (int l = lightStart[node]; l < lightStart[node + 1]; ++l) {
+                        lightGroupVals[groupLights[l]] = 0.0f;
+                    }
+                    ImpulseOutput[node] = 0.0f;
+                    nextChunk[node] = 0.0f;
+                    liveNode[node] = false;
+                    liveNodes[i] = liveNodes[--liveCount];
+                } else {
+                    ++i;
                 }
-            } 
-            
+            }
+
             // After processing, reset the accumulated time
             accumulatedTime -= baseSampleTime; // Subtract to maintain precision and handle any excess
+            tick++;
             
         }//if (accumulated_time...
 
-        //Interpolate outputs in realtime        
-        for (int i=0; i<MAX_NODES; i++){
+        //Interpolate outputs in realtime (retired nodes stay at 0)
+        for (int n=0; n<liveCount; n++){
+            int i = liveNodes[n];
             float currentOutput = outputs[_01_OUTPUT+i].getVoltage();
             currentOutput += nextChunk[i]* 1/ChunkLength;
             currentOutput = (currentOutput < 0.0001f) ? 0.0f : currentOutput;   //round to 0.0 if below threshold.         
@@ -462,11 +581,10 @@ struct ImpulseControllerWidget : ModuleWidget {
         ImpulseController* module = dynamic_cast<ImpulseController*>(this->module);
         if (!module) return;
 
-        for (int groupIndex = 0; groupIndex < MAX_NODES; ++groupIndex) {
-            for (ImpulseController::LightId lightId : module->lightGroups[groupIndex]) {
-                float lightBrightness = clamp(module->lightGroupVals[lightId], 0.f, 1.f);
-                module->lights[lightId].setBrightness(lightBrightness);
-            }
+        for (int i = 0; i < module->lightStart[MAX_NODES]; ++i) {
+            ImpulseController::LightId lightId = module->groupLights[i];
+            float lightBrightness = clamp(module->lightGroupVals[lightId], 0.f, 1.f);
+            module->lights[lightId].setBrightness(lightBrightness);
         }
         ModuleWidget::step();        
     }     
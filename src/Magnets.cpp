@@ -14,12 +14,346 @@
 #include <random>
 #include <algorithm> // For std::shuffle
 #include <vector>    // For std::vector
+#include <atomic>
 using namespace rack;
+using simd::float_4;
 
 // Assuming each light group represents a 5x5 section of the larger grid, and there's 25 such sections
 #define GRID_WIDTH 25
 #define GRID_HEIGHT 25
 #define NUM_SECTIONS 25 // 25  5x5 sections
+#define NUM_SPINS (GRID_WIDTH * GRID_HEIGHT)
+
+// Four independent xorshift32 streams, one per float_4 lane, for the
+// per-site random numbers of the checkerboard sweep
+struct MagnetsLaneRng {
+    uint32_t state[4] = {0x9e3779b9u, 0x7f4a7c15u, 0x85ebca6bu, 0xc2b2ae35u};
+
+    void seed(uint32_t s) {
+        for (int k = 0; k < 4; k++) {
+            uint32_t z = s + 0x9e3779b9u * (k + 1);
+            z = (z ^ (z >> 16)) * 0x85ebca6bu;
+            z = (z ^ (z >> 13)) * 0xc2b2ae35u;
+            z ^= z >> 16;
+            state[k] = z ? z : 1u;
+        }
+    }
+
+    uint32_t next(int lane) {
+        uint32_t x = state[lane];
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        state[lane] = x;
+        return x;
+    }
+
+    float_4 uniform() {
+        float r[4];
+        for (int k = 0; k < 4; k++) {
+            r[k] = (next(k) >> 8) * (1.f / 16777216.f);
+        }
+        return float_4::load(r);
+    }
+};
+
+// Site view of the 25x25 float lattice for the cluster engine
+struct MagnetsFloatSites {
+    float* spins;
+    const int (*neighbors)[4];
+
+    int count() const { return NUM_SPINS; }
+    bool up(int site) const { return spins[site] > 0.f; }
+    void flip(int site) { spins[site] = -spins[site]; }
+    void neighborsOf(int site, int* out) const {
+        for (int k = 0; k < 4; ++k) out[k] = neighbors[site][k];
+    }
+};
+
+// Bit-packed lattice for the larger sizes, decoupled from the 25x25 light
+// grid: one bit per spin (1 = up), rows of size/64 words (a single 32-bit
+// word for size 32). Metropolis uses multi-spin coding on a checkerboard:
+// the four neighbour words give, per bit, how many bonds a flip would
+// break, and a whole word of one colour is accepted or rejected at once.
+// Outputs read block-averaged magnetisation from per-row popcounts of the
+// five section columns, recounted only for rows that changed; the panel
+// lights average 25x25 blocks at UI rate.
+struct MagnetsBitLattice {
+    static constexpr int MAX_SIZE = 256;
+    static constexpr int MAX_WORDS = MAX_SIZE / 64;
+    static constexpr int ACCEPT_BITS = 8;        // resolution of acceptance probabilities
+    static constexpr int WORDS_PER_UPDATE = 32;  // sweep work per update interval
+
+    // Bits of a row in one block column; a column never spans more than two words
+    struct ColumnMask {
+        int word[2];
+        uint64_t mask[2];
+        int width;
+
+        int count(const uint64_t* row) const {
+            int n = __builtin_popcountll(row[word[0]] & mask[0]);
+            if (word[1] >= 0) n += __builtin_popcountll(row[word[1]] & mask[1]);
+            return n;
+        }
+    };
+
+    int size = 0;
+    int sizeShift = 0;  // log2(size)
+    int wordsPerRow = 1;
+    uint64_t wordMask = ~0ull;
+    uint64_t spins[MAX_SIZE * MAX_WORDS];
+    uint64_t rngState = 0x9e3779b97f4a7c15ull;
+    int cursor = 0;  // next word of the sweep, colour-major
+
+    ColumnMask lightColumns[GRID_WIDTH];
+    ColumnMask sectionColumns[5];
+    int rowLight[MAX_SIZE];
+    int lightHeight[GRID_HEIGHT];
+    int sectionHeight[5];
+    uint8_t rowCounts[MAX_SIZE][5];  // up spins of a row in each section column
+    int sectionCounts[5][5];
+    bool rowDirty[MAX_SIZE];
+
+    // Lattice region under the central (head) section
+    int centralLo, centralHi;
+    uint64_t centralMask[MAX_WORDS];
+
+    void configure(int latticeSize, uint64_t seed) {
+        size = latticeSize;
+        sizeShift = __builtin_ctz(size);
+        wordsPerRow = std::max(1, size / 64);
+        wordMask = (size < 64) ? ((1ull << size) - 1) : ~0ull;
+        rngState = seed ? seed : 0x9e3779b97f4a7c15ull;
+        cursor = 0;
+
+        buildColumns(lightColumns, GRID_WIDTH);
+        buildColumns(sectionColumns, 5);
+        for (int i = 0; i < GRID_HEIGHT; ++i) lightHeight[i] = lightColumns[i].width;
+        for (int i = 0; i < 5; ++i) sectionHeight[i] = sectionColumns[i].width;
+        for (int y = 0; y < size; ++y) rowLight[y] = y * GRID_HEIGHT / size;
+
+        std::fill(centralMask, centralMask + MAX_WORDS, 0ull);
+        centralLo = size;
+        centralHi = 0;
+        for (int i = 0; i < size; ++i) {
+            if (i * 5 / size == 2) {
+                centralLo = std::min(centralLo, i);
+                centralHi = std::max(centralHi, i + 1);
+                centralMask[i >> 6] |= 1ull << (i & 63);
+            }
+        }
+
+        for (int i = 0; i < size * wordsPerRow; ++i) {
+            spins[i] = next() & wordMask;
+        }
+        std::memset(rowCounts, 0, sizeof(rowCounts));
+        std::memset(sectionCounts, 0, sizeof(sectionCounts));
+        std::fill(rowDirty, rowDirty + size, true);
+        refreshCounts();
+    }
+
+    // Split the row into 'count' block columns; bit x goes to column x * count / size
+    void buildColumns(ColumnMask* columns, int count) {
+        for (int c = 0; c < count; ++c) {
+            columns[c].word[0] = columns[c].word[1] = -1;
+            columns[c].mask[0] = columns[c].mask[1] = 0;
+            columns[c].width = 0;
+        }
+        for (int x = 0; x < size; ++x) {
+            ColumnMask& column = columns[x * count / size];
+            int w = x >> 6;
+            int k = (column.word[0] < 0 || column.word[0] == w) ? 0 : 1;
+            column.word[k] = w;
+            column.mask[k] |= 1ull << (x & 63);
+            column.width++;
+        }
+    }
+
+    uint64_t next() {  // xorshift64*
+        rngState ^= rngState >> 12;
+        rngState ^= rngState << 25;
+        rngState ^= rngState >> 27;
+        return rngState * 0x2545f4914f6cdd1dull;
+    }
+
+    static uint32_t quantize(float p) {
+        return (uint32_t)(clamp(p, 0.f, 1.f) * (1 << ACCEPT_BITS) + 0.5f);
+    }
+
+    // A word whose bits are independently set with probability p / 2^ACCEPT_BITS,
+    // built from p's binary digits, least significant first
+    uint64_t bernoulli(uint32_t p) {
+        if (p == 0) return 0;
+        if (p >= (1u << ACCEPT_BITS)) return ~0ull;
+        uint64_t m = 0;
+        for (int j = __builtin_ctz(p); j < ACCEPT_BITS; ++j) {
+            uint64_t r = next();
+            m = ((p >> j) & 1) ? (r | m) : (r & m);
+        }
+        return m;
+    }
+
+    bool get(int x, int y) const {
+        return (spins[y * wordsPerRow + (x >> 6)] >> (x & 63)) & 1;
+    }
+
+    void set(int x, int y, bool up) {
+        uint64_t& word = spins[y * wordsPerRow + (x >> 6)];
+        uint64_t bit = 1ull << (x & 63);
+        word = up ? (word | bit) : (word & ~bit);
+        rowDirty[y] = true;
+    }
+
+    // Site view for the cluster engine: site = y * size + x. Rows are
+    // stored contiguously, so bit (site & 63) of word (site >> 6) is the
+    // site for every size except 32, where rows are padded to 64 bits.
+    int count() const { return size * size; }
+    bool up(int site) const {
+        return get(site & (size - 1), site >> sizeShift);
+    }
+    void flip(int site) {
+        int x = site & (size - 1), y = site >> sizeShift;
+        spins[y * wordsPerRow + (x >> 6)] ^= 1ull << (x & 63);
+        rowDirty[y] = true;
+    }
+    void neighborsOf(int site, int* out) const {
+        int x = site & (size - 1), row = site - x;
+        int last = size * (size - 1);
+        out[0] = row + ((x - 1) & (size - 1));
+        out[1] = row + ((x + 1) & (size - 1));
+        out[2] = (row == 0 ? last : row - size) + x;
+        out[3] = (row == last ? 0 : row + size) + x;
+    }
+
+    // Continue the checkerboard sweep by WORDS_PER_UPDATE words
+    void sweep(float accept2, float polarization) {
+        uint32_t p2 = quantize(accept2);  // s * sum == 2; the s * sum == 4 case is p2 squared
+        uint32_t pBias = quantize(std::fabs(polarization - 0.5f));
+        bool biasUp = polarization > 0.5f;
+        int wordsPerColor = size * wordsPerRow;
+
+        for (int n = 0; n < WORDS_PER_UPDATE; ++n) {
+            int color = cursor / wordsPerColor;
+            int y = (cursor % wordsPerColor) / wordsPerRow;
+            int w = cursor % wordsPerRow;
+            updateWord(color, y, w, p2, pBias, biasUp);
+            if (++cursor >= 2 * wordsPerColor) cursor = 0;
+        }
+    }
+
+    void updateWord(int color, int y, int w, uint32_t p2, uint32_t pBias, bool biasUp) {
+        uint64_t* row = &spins[y * wordsPerRow];
+        uint64_t s = row[w];
+        uint64_t left, right;
+        if (size < 64) {
+            left  = ((s << 1) | (s >> (size - 1))) & wordMask;
+            right = ((s >> 1) | (s << (size - 1))) & wordMask;
+        } else {
+            uint64_t prev = row[w == 0 ? wordsPerRow - 1 : w - 1];
+            uint64_t next = row[w == wordsPerRow - 1 ? 0 : w + 1];
+            left  = (s << 1) | (prev >> 63);
+            right = (s >> 1) | (next << 63);
+        }
+        uint64_t up   = spins[(y == 0 ? size - 1 : y - 1) * wordsPerRow + w];
+        uint64_t down = spins[(y == size - 1 ? 0 : y + 1) * wordsPerRow + w];
+
+        // Per bit: which bonds are currently unsatisfied
+        uint64_t a1 = s ^ left, a2 = s ^ right, a3 = s ^ up, a4 = s ^ down;
+        uint64_t any = a1 | a2 | a3 | a4;
+        uint64_t twoOrMore = (a1 & a2) | ((a1 | a2) & (a3 | a4)) | (a3 & a4);
+        uint64_t none = ~any;            // flip breaks 4 bonds: s * sum == 4
+        uint64_t one = any & ~twoOrMore; // flip breaks 2 bonds: s * sum == 2
+
+        uint64_t sites = (((color ^ y) & 1) ? 0xaaaaaaaaaaaaaaaaull : 0x5555555555555555ull) & wordMask;
+        uint64_t accept = twoOrMore;
+        if ((one | none) & sites) {
+            uint64_t r2 = bernoulli(p2);
+            accept |= one & r2;
+            if (none & r2 & sites) accept |= none & r2 & bernoulli(p2);
+        }
+        uint64_t flip = accept & sites;
+        if (!flip) return;
+
+        s ^= flip;
+        // Polarization bias on accepted flips, as in the single-flip engine
+        if (pBias) {
+            uint64_t force = flip & bernoulli(pBias);
+            s = biasUp ? (s | force) : (s & ~force);
+        }
+        row[w] = s;
+        rowDirty[y] = true;
+    }
+
+    void refreshCounts() {
+        for (int y = 0; y < size; ++y) {
+            if (!rowDirty[y]) continue;
+            rowDirty[y] = false;
+            const uint64_t* row = &spins[y * wordsPerRow];
+            int* counts = sectionCounts[y * 5 / size];
+            for (int sx = 0; sx < 5; ++sx) {
+                int count = sectionColumns[sx].count(row);
+                counts[sx] += count - rowCounts[y][sx];
+                rowCounts[y][sx] = count;
+            }
+        }
+    }
+
+    // Randomize everything outside the central block, up with probability 'polarization'
+    void reset(float polarization) {
+        uint32_t p = quantize(polarization);
+        for (int y = 0; y < size; ++y) {
+            bool central = y >= centralLo && y < centralHi;
+            for (int w = 0; w < wordsPerRow; ++w) {
+                uint64_t keep = central ? centralMask[w] : 0ull;
+                uint64_t& word = spins[y * wordsPerRow + w];
+                word = ((word & keep) | (bernoulli(p) & ~keep)) & wordMask;
+            }
+            rowDirty[y] = true;
+        }
+    }
+
+    // Nudge the central block toward the head polarization; one site per
+    // 25 of the block, matching the 25x25 lattice's one site per update
+    void pinCentralBlock(float targetPolarization) {
+        refreshCounts();
+        int width = centralHi - centralLo;
+        int area = width * width;
+        float currentAverage = 2.f * sectionCounts[2][2] / area - 1.f;
+        bool setUp = currentAverage < targetPolarization;
+        for (int n = std::max(1, area / 25); n > 0; --n) {
+            uint64_t r = next();
+            int x = centralLo + (int)((r & 0xffffffffull) % width);
+            int y = centralLo + (int)((r >> 32) % width);
+            set(x, y, setUp);
+        }
+    }
+
+    // Mean magnetisation of each 5x5 section
+    void sectionAverages(float* sectionStates) {
+        refreshCounts();
+        for (int sy = 0; sy < 5; ++sy) {
+            for (int sx = 0; sx < 5; ++sx) {
+                int area = sectionHeight[sy] * sectionColumns[sx].width;
+                sectionStates[sy * 5 + sx] = 2.f * sectionCounts[sy][sx] / area - 1.f;
+            }
+        }
+    }
+
+    // Up-fraction of the block under each light
+    void lightLevels(float* levels) const {
+        int counts[GRID_HEIGHT][GRID_WIDTH] = {};
+        for (int y = 0; y < size; ++y) {
+            const uint64_t* row = &spins[y * wordsPerRow];
+            int* lightRow = counts[rowLight[y]];
+            for (int lx = 0; lx < GRID_WIDTH; ++lx) lightRow[lx] += lightColumns[lx].count(row);
+        }
+        for (int ly = 0; ly < GRID_HEIGHT; ++ly) {
+            for (int lx = 0; lx < GRID_WIDTH; ++lx) {
+                levels[ly * GRID_WIDTH + lx] = (float)counts[ly][lx] / (lightHeight[ly] * lightColumns[lx].width);
+            }
+        }
+    }
+};
 
 struct Magnets : Module {
     enum ParamIds {
@@ -61,6 +395,70 @@ struct Magnets : Module {
     dsp::SchmittTrigger ResetBut;
 
 
+    // Update engines: the original single random spin flip per update, or a
+    // full red/black checkerboard sweep per update. Sites of one colour
+    // have no neighbours of that colour, so the sweep updates them four at
+    // a time with float_4 compares and selects. Larger lattices always use
+    // their bit-packed checkerboard sweep for either of these.
+    // The Wolff engine flips whole clusters, which keeps domains moving
+    // near and below the critical temperature where Metropolis freezes.
+    enum UpdateEngine {
+        SINGLE_FLIP_ENGINE,
+        CHECKERBOARD_ENGINE,
+        WOLFF_ENGINE
+    };
+    int updateEngine = SINGLE_FLIP_ENGINE;
+
+    // Neighbour indices (left, right, up, down) with periodic boundaries
+    int neighbors[NUM_SPINS][4];
+    // Sites of each checkerboard colour, in row-major order
+    int colorSites[2][(NUM_SPINS + 1) / 2];
+    int colorCount[2] = {0, 0};
+    MagnetsLaneRng laneRng;
+
+    // Metropolis acceptance probability indexed by (s * sum(neighbours) + 4) / 2.
+    // deltaE = 2J * s * sum can only take five values, so exp() is only
+    // evaluated when temperature or interaction strength change.
+    float acceptance[5] = {1.f, 1.f, 1.f, 1.f, 1.f};
+    float acceptanceTemp = -1.f;
+    float acceptanceInteraction = -1.f;
+    float bondProbability = 0.f;  // Wolff: 1 - exp(-J / T)
+
+    // Wolff cluster state. The stack holds sites added (and already flipped)
+    // but not yet expanded; it is sized for the largest lattice up front.
+    // Growth stops after WOLFF_BUDGET expanded sites per update, and an
+    // unfinished cluster carries over to the next update.
+    static constexpr int WOLFF_BUDGET = 128;
+    std::vector<int> wolffStack;
+    int wolffTop = 0;
+    bool wolffClusterUp = false;  // spin of the cluster before flipping
+
+    // Lattice sizes: the original 25x25 float lattice (one spin per light),
+    // or a larger bit-packed lattice shown as block averages. The menu sets
+    // latticeSize; process() applies it.
+    enum LatticeSize {
+        LATTICE_25,
+        LATTICE_32,
+        LATTICE_64,
+        LATTICE_128,
+        LATTICE_256,
+        LATTICE_SIZES_LEN
+    };
+    int latticeSize = LATTICE_25;
+    int activeLatticeSize = LATTICE_25;
+    MagnetsBitLattice bitLattice;
+
+    // Block averages of the bit lattice, computed on the engine thread at
+    // light rate; the widget only reads these, never the lattice itself.
+    float blockLightLevels[NUM_SPINS] = {};
+    std::atomic<bool> blockLightsReady{false};
+    dsp::ClockDivider lightDivider;
+
+    static int latticeDimension(int size) {
+        static const int dimensions[LATTICE_SIZES_LEN] = {25, 32, 64, 128, 256};
+        return dimensions[size];
+    }
+
     float resetCount=0;
     float head = 0.0f;
     float spinStates[625]={0.0f};
@@ -79,6 +477,8 @@ struct Magnets : Module {
 
         // Save the state of VoltRange as a boolean
         json_object_set_new(rootJ, "VoltRange", json_boolean(VoltRange));
+        json_object_set_new(rootJ, "updateEngine", json_integer(updateEngine));
+        json_object_set_new(rootJ, "latticeSize", json_integer(latticeSize));
 
         return rootJ;
     }
@@ -90,6 +490,14 @@ struct Magnets : Module {
         if (VoltRangeJ) { // Adds braces for consistency and future-proofing
             VoltRange = json_is_true(VoltRangeJ);
         }
+        json_t* updateEngineJ = json_object_get(rootJ, "updateEngine");
+        if (updateEngineJ) {
+            updateEngine = clamp((int)json_integer_value(updateEngineJ), (int)SINGLE_FLIP_ENGINE, (int)WOLFF_ENGINE);
+        }
+        json_t* latticeSizeJ = json_object_get(rootJ, "latticeSize");
+        if (latticeSizeJ) {
+            latticeSize = clamp((int)json_integer_value(latticeSizeJ), 0, LATTICE_SIZES_LEN - 1);
+        }
     }
     
     Magnets() {
@@ -123,12 +531,156 @@ struct Magnets : Module {
         for (int i = 0; i < GRID_WIDTH * GRID_HEIGHT; ++i) {
             lights[LIGHTS_START + i].setBrightness(0.f);
         }
+        lightDivider.setDivision(512);
 
         for (int i = 0; i < 625; ++i) {
             spinStates[i] = distr(eng) > 0.5 ? 1.0f : -1.0f;
         }     
+
+        for (int y = 0; y < GRID_HEIGHT; ++y) {
+            for (int x = 0; x < GRID_WIDTH; ++x) {
+                int index = y * GRID_WIDTH + x;
+                neighbors[index][0] = ((x - 1 + GRID_WIDTH) % GRID_WIDTH) + y * GRID_WIDTH;
+                neighbors[index][1] = ((x + 1) % GRID_WIDTH) + y * GRID_WIDTH;
+                neighbors[index][2] = x + ((y - 1 + GRID_HEIGHT) % GRID_HEIGHT) * GRID_WIDTH;
+                neighbors[index][3] = x + ((y + 1) % GRID_HEIGHT) * GRID_WIDTH;
+
+                // On an odd lattice the periodic seam joins two sites of the
+                // same colour; they are a row (or the whole grid) apart in
+                // this order, so they never share a group of four
+                int color = (x + y) & 1;
+                colorSites[color][colorCount[color]++] = index;
+            }
+        }
+        laneRng.seed(eng());
+        wolffStack.resize(MagnetsBitLattice::MAX_SIZE * MagnetsBitLattice::MAX_SIZE);
     }//Magnets()
 
+    void updateAcceptance(float temperature, float interactionStrength) {
+        if (temperature == acceptanceTemp && interactionStrength == acceptanceInteraction) return;
+        acceptanceTemp = temperature;
+        acceptanceInteraction = interactionStrength;
+        for (int k = 0; k < 5; ++k) {
+            float deltaE = 2.f * interactionStrength * (2 * k - 4);
+            if (deltaE <= 0.f) {
+                acceptance[k] = 1.f;
+            } else {
+                acceptance[k] = (temperature > 0.f) ? std::exp(-deltaE / (temperature * 2.0f)) : 0.f;
+            }
+        }
+        // exp(-J / T) is the square root of the s * sum == 2 entry
+        bondProbability = 1.f - std::sqrt(acceptance[3]);
+    }
+
+    // Grow and flip Wolff clusters until WOLFF_BUDGET sites have been
+    // expanded. Each site is flipped as it joins, so the spin test alone
+    // keeps it from joining twice. The polarization bias works per cluster:
+    // with probability |polarization - 0.5| a cluster that would flip away
+    // from the polarized direction is left alone.
+    template <typename Sites>
+    void wolffUpdate(Sites& sites, float polarization) {
+        uint32_t bondThreshold = (uint32_t)std::min(bondProbability * 4294967296.f, 4294967295.f);
+        uint32_t biasThreshold = (uint32_t)std::min(std::fabs(polarization - 0.5f) * 4294967296.f, 4294967295.f);
+        bool biasUp = polarization > 0.5f;
+        int n = sites.count();
+        int* stack = wolffStack.data();
+        int top = wolffTop;
+        int budget = WOLFF_BUDGET;
+
+        while (budget > 0) {
+            if (top == 0) {
+                // Start a new cluster
+                int seed = (int)(((uint64_t)laneRng.next(0) * n) >> 32);
+                wolffClusterUp = sites.up(seed);
+                budget--;
+                if (polarization != 0.5f && wolffClusterUp == biasUp && laneRng.next(1) < biasThreshold) {
+                    continue;
+                }
+                sites.flip(seed);
+                stack[top++] = seed;
+            }
+
+            int site = stack[--top];
+            budget--;
+            int neighbors[4];
+            sites.neighborsOf(site, neighbors);
+            for (int k = 0; k < 4; ++k) {
+                int neighbor = neighbors[k];
+                if (sites.up(neighbor) == wolffClusterUp && laneRng.next(0) < bondThreshold) {
+                    sites.flip(neighbor);
+                    stack[top++] = neighbor;
+                }
+            }
+        }
+        wolffTop = top;
+    }
+
+    // Example Magnets model update (single spin flip attempt per interval)
+    void singleFlipUpdate(float polarization) {
+        std::uniform_int_distribution<int> distr_spin(0, NUM_SPINS - 1); // For selecting random spin
+        int index = distr_spin(eng); // Randomly choose a spin
+        const int* n = neighbors[index];
+        float sum = spinStates[n[0]] + spinStates[n[1]] + spinStates[n[2]] + spinStates[n[3]];
+        int k = (int)(spinStates[index] * sum + 4.f) / 2;
+
+        //////////////
+        // Metropolis criterion with a  polarization effect
+        if (acceptance[k] >= 1.f || distr(eng) < acceptance[k]) {
+            spinStates[index] *= -1; // Flip the spin
+
+            //Let polarization bias spin states with probability proportional to the degree of polarization
+            //This lets the array act like it's under a recorder head
+            if( distr(eng)< (1 * abs(polarization - 0.5) ) ){  
+                if (polarization > 0.5){
+                    spinStates[index]=1.0f;
+                } else if (polarization < 0.5) {
+                    spinStates[index]=-1.0f;
+                }
+            }
+        }
+    }
+
+    // One full sweep: every site of one colour, then every site of the other
+    void checkerboardSweep(float polarization) {
+        float bias = std::fabs(polarization - 0.5f);
+        float_4 biasSpin = float_4(polarization > 0.5f ? 1.f : -1.f);
+        bool biased = polarization != 0.5f;
+        float_4 accept2 = float_4(acceptance[3]);  // s * sum == 2
+        float_4 accept4 = float_4(acceptance[4]);  // s * sum == 4
+
+        for (int color = 0; color < 2; ++color) {
+            const int* sites = colorSites[color];
+            int count = colorCount[color];
+            for (int i = 0; i < count; i += 4) {
+                int lanes = std::min(4, count - i);
+                float s[4] = {}, sum[4] = {};
+                for (int l = 0; l < lanes; ++l) {
+                    int index = sites[i + l];
+                    const int* n = neighbors[index];
+                    s[l] = spinStates[index];
+                    sum[l] = spinStates[n[0]] + spinStates[n[1]] + spinStates[n[2]] + spinStates[n[3]];
+                }
+                float_4 spin = float_4::load(s);
+                float_4 align = spin * float_4::load(sum);
+
+                // Acceptance from the table: 1 unless the flip costs energy
+                float_4 p = simd::ifelse(align > 3.f, accept4, simd::ifelse(align > 1.f, accept2, float_4(1.f)));
+                float_4 flip = laneRng.uniform() < p;
+                float_4 next = simd::ifelse(flip, -spin, spin);
+                if (biased) {
+                    float_4 force = flip & (laneRng.uniform() < float_4(bias));
+                    next = simd::ifelse(force, biasSpin, next);
+                }
+
+                float out[4];
+                next.store(out);
+                for (int l = 0; l < lanes; ++l) {
+                    spinStates[sites[i + l]] = out[l];
+                }
+            }
+        }
+    }
+
     void process(const ProcessArgs &args) override {    
         // Read parameters and apply attenuations from CV inputs
         float temperature = params[TEMP_PARAM].getValue();
@@ -149,6 +701,16 @@ struct Magnets : Module {
         polarization = 0.5f * polarization + 0.5f;
         interactionStrength = clamp(interactionStrength, 0.f, 1.f);
 
+        if (latticeSize != activeLatticeSize) {
+            blockLightsReady = false;
+            if (latticeSize != LATTICE_25) {
+                bitLattice.configure(latticeDimension(latticeSize), ((uint64_t)eng() << 32) | eng());
+            }
+            activeLatticeSize = latticeSize;
+            wolffTop = 0;
+            lightDivider.reset();
+        }
+
         if ( Reset.process( inputs[RESET_INPUT].getVoltage() ) || ResetBut.process(params[RESET_BUTTON].getValue()) ) {
             resetSpinStates(polarization);
         }
@@ -159,41 +721,25 @@ struct Magnets : Module {
         if (phase >= updateInterval) {
             phase -= updateInterval;
 
-            std::uniform_int_distribution<int> distr_spin(0, GRID_WIDTH * GRID_HEIGHT - 1); // For selecting random spin
-
             // Reset the INPUT grid every update cycle
             resetInputGrid();
 
-            // Example Magnets model update (single spin flip attempt per interval)
-            int index = distr_spin(eng); // Randomly choose a spin
-            int x = index % GRID_WIDTH;
-            int y = index / GRID_WIDTH;
-
-            // Calculate coordinates of nearest neighbors with periodic boundary conditions
-            int left = ((x - 1 + GRID_WIDTH) % GRID_WIDTH) + y * GRID_WIDTH;
-            int right = ((x + 1) % GRID_WIDTH) + y * GRID_WIDTH;
-            int up = x + ((y - 1 + GRID_HEIGHT) % GRID_HEIGHT) * GRID_WIDTH;
-            int down = x + ((y + 1) % GRID_HEIGHT) * GRID_WIDTH;
-
-            // Calculate energy change if this spin were flipped
-            float deltaE = 2 * interactionStrength * spinStates[index] * (spinStates[left] + spinStates[right] + spinStates[up] + spinStates[down]);
-
-            //////////////
-            // Metropolis criterion with a  polarization effect
-            if (deltaE <= 0 || ( distr(eng) < exp(-deltaE / (temperature * 2.0f) ) ) ) {
-                spinStates[index] *= -1; // Flip the spin
-
-                //Let polarization bias spin states with probability proportional to the degree of polarization
-                //This lets the array act like it's under a recorder head
-                if( distr(eng)< (1 * abs(polarization - 0.5) ) ){  
-                    if (polarization > 0.5){
-                        spinStates[index]=1.0f;
-                    } else if (polarization < 0.5) {
-                        spinStates[index]=-1.0f;
-                    }
+            updateAcceptance(temperature, interactionStrength);
+            if (updateEngine == WOLFF_ENGINE) {
+                if (activeLatticeSize != LATTICE_25) {
+                    wolffUpdate(bitLattice, polarization);
+                } else {
+                    MagnetsFloatSites floatSites{spinStates, neighbors};
+                    wolffUpdate(floatSites, polarization);
                 }
+            } else if (activeLatticeSize != LATTICE_25) {
+                bitLattice.sweep(acceptance[3], polarization);
+            } else if (updateEngine == CHECKERBOARD_ENGINE) {
+                checkerboardSweep(polarization);
+            } else {
+                singleFlipUpdate(polarization);
             }
-                        
+
             phase = 0.f; // Reset phase for the next interval
             outputInterpolationPhase = 0.f; // Reset interpolation phase
 
@@ -203,28 +749,32 @@ struct Magnets : Module {
                 currentOutputStates[i] = 0.f; // Will be recalculated
             }
 
-            // Iterate over all spin states to update corresponding section output states
-            for (int y = 0; y < GRID_HEIGHT; ++y) {
-                for (int x = 0; x < GRID_WIDTH; ++x) {
-                    // Calculate the linear index correctly using zero-based indexing
-                    int index = y * GRID_WIDTH + x;
+            if (activeLatticeSize != LATTICE_25) {
+                bitLattice.sectionAverages(currentOutputStates);
+            } else {
+                // Iterate over all spin states to update corresponding section output states
+                for (int y = 0; y < GRID_HEIGHT; ++y) {
+                    for (int x = 0; x < GRID_WIDTH; ++x) {
+                        // Calculate the linear index correctly using zero-based indexing
+                        int index = y * GRID_WIDTH + x;
 
-                    // Calculate the section index. Adjust for sections beyond the central exclusion
-                    int sectionX = x / 5;
-                    int sectionY = y / 5;
-                    int section = sectionY * 5 + sectionX;
+                        // Calculate the section index. Adjust for sections beyond the central exclusion
+                        int sectionX = x / 5;
+                        int sectionY = y / 5;
+                        int section = sectionY * 5 + sectionX;
 
-                    // Safeguard to prevent out-of-range access
-                    if (section < 0 || section >= NUM_SECTIONS) continue;
+                        // Safeguard to prevent out-of-range access
+                        if (section < 0 || section >= NUM_SECTIONS) continue;
 
-                    // Update the section's current output state based on spin state
-                    currentOutputStates[section] += (spinStates[index] > 0) ? 1.f : -1.f;
+                        // Update the section's current output state based on spin state
+                        currentOutputStates[section] += (spinStates[index] > 0) ? 1.f : -1.f;
+                    }
                 }
-            }
 
-            // Normalize the current output states based on the number of spins per section
-            for (int i = 0; i < NUM_SECTIONS; ++i) {
-                currentOutputStates[i] /= 25.f; // Assuming each section (except central) has 25 spins
+                // Normalize the current output states based on the number of spins per section
+                for (int i = 0; i < NUM_SECTIONS; ++i) {
+                    currentOutputStates[i] /= 25.f; // Assuming each section (except central) has 25 spins
+                }
             }
  
         }
@@ -272,9 +822,22 @@ struct Magnets : Module {
                 lights[LIGHTS_START + centralLightIndex].setBrightness(currentOutputStates[sectionY*5 + sectionX]); 
             }
         }
+
+        // Larger lattices are shown as block averages, refreshed at light rate
+        if (activeLatticeSize != LATTICE_25 && (!blockLightsReady || lightDivider.process())) {
+            bitLattice.lightLevels(blockLightLevels);
+            blockLightsReady = true;
+        }
     }//void process
     
     void resetSpinStates(float polarization) {
+        wolffTop = 0;  // drop any cluster in progress
+
+        if (activeLatticeSize != LATTICE_25) {
+            bitLattice.reset(polarization);
+            return;
+        }
+
         int indexes[600]; // array for indexes
         int indexCount = 0; // Keep track of the actual number of indexes used
 
@@ -305,6 +868,11 @@ struct Magnets : Module {
         // Calculate target polarization from HEAD_INPUT voltage
         float targetPolarization = (inputs[HEAD_INPUT].getVoltage() / 5.0f); 
         targetPolarization = clamp(targetPolarization, -1.0f, 1.0f);
+
+        if (activeLatticeSize != LATTICE_25) {
+            bitLattice.pinCentralBlock(targetPolarization);
+            return;
+        }
     
         // Define the bounds of the central 5x5 grid within the 25x25 layout
         int startX = 10, endX = 15; // Horizontal bounds for the central grid
@@ -445,15 +1013,82 @@ struct MagnetsWidget : ModuleWidget {
         item->text = "Voltage Range ±5V";
         item->MagnetsModule = MagnetsModule; // Ensure we're setting the module
         menu->addChild(item);
+
+        menu->addChild(new MenuSeparator());
+        menu->addChild(createMenuLabel("Update engine"));
+
+        struct EngineMenuItem : MenuItem {
+            Magnets* MagnetsModule;
+            int engine;
+            void onAction(const event::Action& e) override {
+                MagnetsModule->updateEngine = engine;
+            }
+            void step() override {
+                rightText = (MagnetsModule->updateEngine == engine) ? "✔" : "";
+                MenuItem::step();
+            }
+        };
+
+        struct EngineOption { const char* label; int engine; };
+        const std::vector<EngineOption> engineOptions = {
+            {"Single spin flip (default, 25x25 only)", Magnets::SINGLE_FLIP_ENGINE},
+            {"Checkerboard sweep (full lattice per update)", Magnets::CHECKERBOARD_ENGINE},
+            {"Wolff clusters (keeps moving when cold)", Magnets::WOLFF_ENGINE},
+        };
+        for (auto& opt : engineOptions) {
+            EngineMenuItem* engineItem = new EngineMenuItem();
+            engineItem->text = opt.label;
+            engineItem->engine = opt.engine;
+            engineItem->MagnetsModule = MagnetsModule;
+            menu->addChild(engineItem);
+        }
+
+        menu->addChild(new MenuSeparator());
+        menu->addChild(createMenuLabel("Lattice size"));
+
+        struct LatticeSizeMenuItem : MenuItem {
+            Magnets* MagnetsModule;
+            int size;
+            void onAction(const event::Action& e) override {
+                MagnetsModule->latticeSize = size;
+            }
+            void step() override {
+                rightText = (MagnetsModule->latticeSize == size) ? "✔" : "";
+                MenuItem::step();
+            }
+        };
+
+        struct LatticeSizeOption { const char* label; int size; };
+        const std::vector<LatticeSizeOption> latticeSizeOptions = {
+            {"25x25 (one spin per light, default)", Magnets::LATTICE_25},
+            {"32x32", Magnets::LATTICE_32},
+            {"64x64", Magnets::LATTICE_64},
+            {"128x128", Magnets::LATTICE_128},
+            {"256x256 (smoothest transitions)", Magnets::LATTICE_256},
+        };
+        for (auto& opt : latticeSizeOptions) {
+            LatticeSizeMenuItem* sizeItem = new LatticeSizeMenuItem();
+            sizeItem->text = opt.label;
+            sizeItem->size = opt.size;
+            sizeItem->MagnetsModule = MagnetsModule;
+            menu->addChild(sizeItem);
+        }
     }
 
     void step() override {
         Magnets* module = dynamic_cast<Magnets*>(this->module);
         if (!module) return;
 
+        // Larger lattices are shown as block averages
+        bool blockAveraged = module->blockLightsReady;
+
         // After updating, set the light states
         for (int i = 0; i < GRID_WIDTH * GRID_HEIGHT; ++i) {
             int lightIndex = module->LIGHTS_START + i;
+            if (blockAveraged) {
+                module->lights[lightIndex].setBrightness(module->blockLightLevels[i]);
+                continue;
+            }
             bool spinUp = module->spinStates[i] > 0;
             module->lights[lightIndex].setBrightness(spinUp ? 1.f : 0.f);
         } 
@@ -46,38 +46,7 @@ struct SecondOrderHPF {
     }
 };
 
-#include "Filter6pButter.h"
-#define OVERSAMPLING_FACTOR 8
-class OverSamplingShaper {
-public:
-    OverSamplingShaper() {
-        interpolatingFilter.setCutoffFreq(1.f / (OVERSAMPLING_FACTOR * 4));
-        decimatingFilter.setCutoffFreq(1.f / (OVERSAMPLING_FACTOR * 4));
-    }
-    float process(float input) {
-        float signal;
-        for (int i = 0; i < OVERSAMPLING_FACTOR; ++i) {
-            signal = (i == 0) ? input * OVERSAMPLING_FACTOR : 0.f;
-            signal = interpolatingFilter.process(signal);
-            signal = processShape(signal);
-            signal = decimatingFilter.process(signal);
-        }
-        return signal;
-    }
-private:
-    virtual float processShape(float) = 0;
-    Filter6PButter interpolatingFilter;
-    Filter6PButter decimatingFilter;
-};
-
-// Define the OverSamplingShaper derived class
-class SimpleShaper : public OverSamplingShaper {
-private:
-    float processShape(float input) override {
-        // No additional shaping; just pass through
-        return input;
-    }
-};
+#include "FilterDuck.h"
 
 struct PreeeeeeeeeeessedDuck : Module {
 
@@ -155,16 +124,19 @@ struct PreeeeeeeeeeessedDuck : Module {
         VOL_LIGHT6R, VOL_LIGHT7R, VOL_LIGHT8R, VOL_LIGHT9R, VOL_LIGHT10R,
         VOL_LIGHT11R, VOL_LIGHT12R, VOL_LIGHT13R, VOL_LIGHT14R, VOL_LIGHT15R,
         VOL_LIGHT16R, VOL_LIGHT17R, VOL_LIGHT18R, VOL_LIGHT19R, VOL_LIGHT20R,
+        OVERSAMPLE_LIGHT,
         NUM_LIGHTS
     };
 
     bool applyFilters = true; // DC filtering on by default
 
-    // Initialize Butterworth filter for oversampling
-    SimpleShaper shaperL;  // Instance of the oversampling and shaping processor
-    SimpleShaper shaperR;  // Instance of the oversampling and shaping processor
-    Filter6PButter butterworthFilter;  // Butterworth filter instance
-    bool isSupersamplingEnabled = false;  // Enable supersampling is off by default
+    // Output saturator, run inside a halfband-oversampled block when driven hard
+    DuckOversampledSaturator saturatorL;
+    DuckOversampledSaturator saturatorR;
+    int oversamplingFactor = 1;  // 1 = off, 2 or 4 = oversample above the clean threshold
+
+    // Expander bus for chaining ducks into one shared compressor and output stage
+    DuckBus duckBus;
 
 
     //for tracking the mute state of each channel
@@ -199,8 +171,11 @@ struct PreeeeeeeeeeessedDuck : Module {
         // Save the state of mutedSideDucks as a boolean
         json_object_set_new(rootJ, "mutedSideDucks", json_boolean(mutedSideDucks));
 
-        // Save the state of isSupersamplingEnabled as a boolean
-        json_object_set_new(rootJ, "isSupersamplingEnabled", json_boolean(isSupersamplingEnabled));
+        // Save the output oversampling factor
+        json_object_set_new(rootJ, "oversamplingFactor", json_integer(oversamplingFactor));
+
+        // Save whether this duck sends its mix to the duck on its right
+        json_object_set_new(rootJ, "busSend", json_boolean(duckBus.sendEnabled));
 
         // Save transitionTime
         json_object_set_new(rootJ, "transitionTime", json_real(transitionTime));
@@ -249,10 +224,20 @@ struct PreeeeeeeeeeessedDuck : Module {
             mutedSideDucks = json_is_true(mutedSideDucksJ);
         }
 
-        // Load the state of isSupersamplingEnabled
+        // Load the output oversampling factor, falling back to the old supersampling toggle
+        json_t* oversamplingFactorJ = json_object_get(rootJ, "oversamplingFactor");
         json_t* isSupersamplingEnabledJ = json_object_get(rootJ, "isSupersamplingEnabled");
-        if (isSupersamplingEnabledJ) {
-            isSupersamplingEnabled = json_is_true(isSupersamplingEnabledJ);
+        if (oversamplingFactorJ) {
+            int factor = json_integer_value(oversamplingFactorJ);
+            oversamplingFactor = (factor == 2 || factor == 4) ? factor : 1;
+        } else if (isSupersamplingEnabledJ) {
+            oversamplingFactor = json_is_true(isSupersamplingEnabledJ) ? 2 : 1;
+        }
+
+        // Load the expander bus send state
+        json_t* busSendJ = json_object_get(rootJ, "busSend");
+        if (busSendJ) {
+            duckBus.sendEnabled = json_is_true(busSendJ);
         }
 
         // Load transitionTime
@@ -327,8 +312,6 @@ struct PreeeeeeeeeeessedDuck : Module {
     float volTotalR = 1.0f;
 
     // Arrays to hold last computed values for differentiation
-    float lastOutputL = 0.0f;
-    float lastOutputR = 0.0f;
     float sideEnvelopeL = 0.0f;
     float sideEnvelopeR = 0.0f;
     float sideEnvelope = 0.0f;
@@ -587,6 +570,9 @@ struct PreeeeeeeeeeessedDuck : Module {
         transitionSamples = transitionTime * 0.001f * sampleRate;
         hpfL.setCutoffFrequency(sampleRate, 30.0f);
         hpfR.setCutoffFrequency(sampleRate, 30.0f);
+        saturatorL.setSampleRate(sampleRate);
+        saturatorR.setSampleRate(sampleRate);
+        duckBus.attach(this);
      }
 
     void onSampleRateChange() override {
@@ -594,6 +580,15 @@ struct PreeeeeeeeeeessedDuck : Module {
          transitionSamples = transitionTime * 0.001f * sampleRate;
          hpfL.setCutoffFrequency(sampleRate, 30.0f);
          hpfR.setCutoffFrequency(sampleRate, 30.0f);
+         saturatorL.setSampleRate(sampleRate);
+         saturatorR.setSampleRate(sampleRate);
+    }
+
+    void onExpanderChange(const ExpanderChangeEvent& e) override {
+        // A new left neighbour must not inherit the old one's bus frame
+        if (e.side == 0) {
+            duckBus.reset();
+        }
     }
 
     void onReset(const ResetEvent& e) override {
@@ -625,6 +620,8 @@ struct PreeeeeeeeeeessedDuck : Module {
 			cachedMasterVol = params[MASTER_VOL].getValue();
 			cachedMasterVolAtt = params[MASTER_VOL_ATT].getValue();
 			transitionSamples = transitionTime * 0.001f * sampleRate;
+			saturatorL.setFactor(oversamplingFactor);
+			saturatorR.setFactor(oversamplingFactor);
 		}
 		uiUpdateCounter = (uiUpdateCounter + 1) % UI_UPDATE_DIVIDER;
 
@@ -659,7 +656,7 @@ struct PreeeeeeeeeeessedDuck : Module {
 
 		// Early exit if nothing connected
 		bool sideConnected = inputs[SIDECHAIN_INPUT_L].isConnected() || inputs[SIDECHAIN_INPUT_R].isConnected();
-		if (firstConnectedChannel == -1 && !sideConnected) {
+		if (firstConnectedChannel == -1 && !sideConnected && !duckBus.isLinked(this)) {
 			for (int k = 0; k < 16; ++k) {
 				filteredEnvelopeL[k] = 0.0f;
 				filteredEnvelopeR[k] = 0.0f;
@@ -956,6 +953,30 @@ struct PreeeeeeeeeeessedDuck : Module {
             muteLatch[16] = false;
         }
         
+        // Merge with the expander bus; a sending duck stops here and leaves the
+        // compression and output stage to the master on its right
+        DuckBusFrame localFrame;
+        for (int i = 0; i < 16; i++) {
+            localFrame.mixL += inputL[i];
+            localFrame.mixR += inputR[i];
+        }
+        localFrame.envL = compressionAmountL;
+        localFrame.envR = compressionAmountR;
+        localFrame.inputCount = inputCount;
+
+        DuckBusFrame busFrame = duckBus.merge(this, localFrame);
+        if (duckBus.forward(this, busFrame)) {
+            pressTotalL = pressTotalR = 0.0f;
+            distortTotalL = distortTotalR = 0.0f;
+            volTotalL = volTotalR = 0.0f;
+            outputs[AUDIO_OUTPUT_L].setVoltage(0.0f);
+            outputs[AUDIO_OUTPUT_R].setVoltage(0.0f);
+            return;
+        }
+        compressionAmountL = busFrame.envL;
+        compressionAmountR = busFrame.envR;
+        inputCount = busFrame.inputCount;
+
         float sideChain=0.f;
         if (sideConnected) sideChain = 1.f;
         compressionAmountL = compressionAmountL/((inputCount+sideChain)*5.0f); //divide by the expected ceiling
@@ -977,14 +998,10 @@ struct PreeeeeeeeeeessedDuck : Module {
 
         // MIX the channels scaled by compression
         if (compressionAmountL > 0.0f && inputCount > 0.0f) {
-            for (int i = 0; i < 16; i++) {
-                mixL += inputL[i] * pressTotalL;
-            }
+            mixL = busFrame.mixL * pressTotalL;
         }
         if (compressionAmountR > 0.0f && inputCount > 0.0f) {
-            for (int i = 0; i < 16; i++) {
-                mixR += inputR[i] * pressTotalR;
-            }
+            mixR = busFrame.mixR * pressTotalR;
         }
 
         //////////////
@@ -1098,14 +1115,12 @@ struct PreeeeeeeeeeessedDuck : Module {
         distortTotalL = distortTotalL * decayRate + log1p(fmax(mixL-35.f, 0.0f)) * (35.0f / log1p(35)) * (1.0f - decayRate);
         distortTotalR = distortTotalR * decayRate +log1p(fmax(mixR-35.f, 0.0f)) * (35.0f / log1p(35)) * (1.0f - decayRate);
 
-        // Apply ADAA
+        // Apply ADAA saturation, oversampled when driven past the clean threshold
         float maxHeadRoom = 111.7f; // 1.314*85 exceeding this number results in strange wavefolding due to the polytanh bad fit beyond this point
         mixL = clamp(mixL, -maxHeadRoom, maxHeadRoom);
         mixR = clamp(mixR, -maxHeadRoom, maxHeadRoom);
-        mixL = applyADAA(mixL/85.f, lastOutputL, sampleRate); //85 is 17x5v
-        mixR = applyADAA(mixR/85.f, lastOutputR, sampleRate);
-        lastOutputL = mixL;
-        lastOutputR = mixR;
+        mixL = saturatorL.process(mixL/85.f); //85 is 17x5v
+        mixR = saturatorR.process(mixR/85.f);
 
         // Set outputs
         float masterVol = cachedMasterVol;
@@ -1121,36 +1136,11 @@ struct PreeeeeeeeeeessedDuck : Module {
         volTotalL = volTotalL * decayRate + fabs(outputL) * (1.0f - decayRate);
         volTotalR = volTotalR * decayRate + fabs(outputR) * (1.0f - decayRate);
 
-        if (isSupersamplingEnabled) {
-            // Use the oversampling shaper for the signal
-            outputL = shaperL.process(outputL);
-            outputR = shaperR.process(outputR);
-        }
-
         outputs[AUDIO_OUTPUT_L].setVoltage(outputL);
         outputs[AUDIO_OUTPUT_R].setVoltage(outputR);
 
     }
 
-    float applyADAA(float input, float lastInput, float sampleRate) {
-        float delta = input - lastInput;
-        if (fabs(delta) > 1e-6) {
-            return (antiderivative(input) - antiderivative(lastInput)) / delta;
-        } else {
-            return polyTanh(input);
-        }
-    }
-
-	float antiderivative(float x) {
-		float x2 = x * x;
-		return x2 * (0.5f - x2 * (1.0f/12.0f - x2 * (1.0f/45.0f - 17.0f/2520.0f * x2)));
-	}
-	
-	float polyTanh(float x) {
-		float x2 = x * x;
-		return x - x * x2 * (1.0f/3.0f - x2 * (2.0f/15.0f - 17.0f/315.0f * x2));
-	}
-	
 	float polySin(float x) {
 		float x2 = x * x;
 		return x - x * x2 * (1.0f/6.0f - x2 * (1.0f/120.0f - x2 / 5040.0f));
@@ -1348,6 +1338,9 @@ struct PreeeeeeeeeeessedDuckWidget : ModuleWidget {
         xPos += 1*sliderX; // Shift to the right of the last channel
         addOutput(createOutputCentered<ThemedPJ301MPort>(Vec(xPos, yPos), module, PreeeeeeeeeeessedDuck::AUDIO_OUTPUT_R));
 
+        // Oversampling activity light between the outputs
+        addChild(createLightCentered<TinyLight<YellowLight>>(Vec(xPos - 0.5f*sliderX, yPos), module, PreeeeeeeeeeessedDuck::OVERSAMPLE_LIGHT));
+
     }
 
 	void step() override {
@@ -1371,6 +1364,9 @@ struct PreeeeeeeeeeessedDuckWidget : ModuleWidget {
 		updateSegmentedLights(module, PreeeeeeeeeeessedDuck::FEED_LIGHT1R, module->distortTotalR, 100.0f, 20);
 		updateSegmentedLights(module, PreeeeeeeeeeessedDuck::VOL_LIGHT1, module->volTotalL, 10.0f, 20);
 		updateSegmentedLights(module, PreeeeeeeeeeessedDuck::VOL_LIGHT1R, module->volTotalR, 10.0f, 20);
+
+		module->lights[PreeeeeeeeeeessedDuck::OVERSAMPLE_LIGHT].setBrightness(
+			fmax(module->saturatorL.getOversamplingLevel(), module->saturatorR.getOversamplingLevel()));
 	}
 	
 	void updateSegmentedLights(PreeeeeeeeeeessedDuck* module, int startLightId, float totalValue, float maxValue, int numLights) {
@@ -1484,27 +1480,63 @@ struct PreeeeeeeeeeessedDuckWidget : ModuleWidget {
         mutedSideDucksItem->PreeeeeeeeeeessedDuckModule = PreeeeeeeeeeessedDuckModule;
         menu->addChild(mutedSideDucksItem);
 
-        // Supersampling menu item
-        struct SupersamplingMenuItem : MenuItem {
+        // Expander bus menu item
+        struct BusSendMenuItem : MenuItem {
             PreeeeeeeeeeessedDuck* PreeeeeeeeeeessedDuckModule;
+            void onAction(const event::Action& e) override {
+                // Toggle sending this duck's mix to the duck on the right
+                PreeeeeeeeeeessedDuckModule->duckBus.sendEnabled = !PreeeeeeeeeeessedDuckModule->duckBus.sendEnabled;
+            }
+            void step() override {
+                // Update the display to show a checkmark when the mode is active
+                rightText = PreeeeeeeeeeessedDuckModule->duckBus.sendEnabled ? "✔" : "";
+                MenuItem::step();
+            }
+        };
+
+        BusSendMenuItem* busSendItem = new BusSendMenuItem();
+        busSendItem->text = "Send Mix to Duck on the Right";
+        busSendItem->PreeeeeeeeeeessedDuckModule = PreeeeeeeeeeessedDuckModule;
+        menu->addChild(busSendItem);
+
+        int upstreamDucks = PreeeeeeeeeeessedDuckModule->duckBus.getUpstreamCount();
+        if (upstreamDucks > 0) {
+            menu->addChild(createMenuLabel(string::f("Bus master for %d chained duck%s", upstreamDucks, upstreamDucks > 1 ? "s" : "")));
+        }
+
+        // Output oversampling menu items
+        menu->addChild(createMenuLabel("Output Oversampling"));
+
+        struct OversamplingMenuItem : MenuItem {
+            PreeeeeeeeeeessedDuck* PreeeeeeeeeeessedDuckModule;
+            int factor;
 
             void onAction(const event::Action& e) override {
-                // Toggle the "Supersampling" mode
-                PreeeeeeeeeeessedDuckModule->isSupersamplingEnabled = !PreeeeeeeeeeessedDuckModule->isSupersamplingEnabled;
+                PreeeeeeeeeeessedDuckModule->oversamplingFactor = factor;
             }
 
             void step() override {
-                // Update the display to show a checkmark when the mode is active
-                rightText = PreeeeeeeeeeessedDuckModule->isSupersamplingEnabled ? "✔" : "";
+                // Update the display to show a checkmark on the active factor
+                rightText = (PreeeeeeeeeeessedDuckModule->oversamplingFactor == factor) ? "✔" : "";
                 MenuItem::step();
             }
         };
 
-        // Create the Supersampling menu item and add it to the menu
-        SupersamplingMenuItem* supersamplingItem = new SupersamplingMenuItem();
-        supersamplingItem->text = "Enable Supersampling";
-        supersamplingItem->PreeeeeeeeeeessedDuckModule = PreeeeeeeeeeessedDuckModule;
-        menu->addChild(supersamplingItem);
+        const std::pair<const char*, int> oversamplingOptions[] = {
+            { "Off (base-rate ADAA)", 1 },
+            { "2x when driven",       2 },
+            { "4x when driven",       4 },
+        };
+        // The clean path is delayed to match, so the latency is constant.
+        for (const auto& option : oversamplingOptions) {
+            OversamplingMenuItem* oversamplingItem = new OversamplingMenuItem();
+            oversamplingItem->text = option.first;
+            if (option.second > 1)
+                oversamplingItem->text += string::f(", +%d samples latency", DuckOversampledSaturator::latencyFor(option.second));
+            oversamplingItem->factor = option.second;
+            oversamplingItem->PreeeeeeeeeeessedDuckModule = PreeeeeeeeeeessedDuckModule;
+            menu->addChild(oversamplingItem);
+        }
 
         // Separator for new section
         menu->addChild(new MenuSeparator);
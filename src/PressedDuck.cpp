@@ -46,38 +46,7 @@ struct SecondOrderHPF {
     }
 };
 
-#include "Filter6pButter.h"
-#define OVERSAMPLING_FACTOR 8
-class OverSamplingShaper {
-public:
-    OverSamplingShaper() {
-        interpolatingFilter.setCutoffFreq(1.f / (OVERSAMPLING_FACTOR * 4));
-        decimatingFilter.setCutoffFreq(1.f / (OVERSAMPLING_FACTOR * 4));
-    }
-    float process(float input) {
-        float signal;
-        for (int i = 0; i < OVERSAMPLING_FACTOR; ++i) {
-            signal = (i == 0) ? input * OVERSAMPLING_FACTOR : 0.f;
-            signal = interpolatingFilter.process(signal);
-            signal = processShape(signal);
-            signal = decimatingFilter.process(signal);
-        }
-        return signal;
-    }
-private:
-    virtual float processShape(float) = 0;
-    Filter6PButter interpolatingFilter;
-    Filter6PButter decimatingFilter;
-};
-
-// Define the OverSamplingShaper derived class
-class SimpleShaper : public OverSamplingShaper {
-private:
-    float processShape(float input) override {
-        // No additional shaping; just pass through
-        return input;
-    }
-};
+#include "FilterDuck.h"
 
 struct PressedDuck : Module {
 
@@ -134,16 +103,19 @@ struct PressedDuck : Module {
         VOL_LIGHT6R, VOL_LIGHT7R, VOL_LIGHT8R, VOL_LIGHT9R, VOL_LIGHT10R,
         VOL_LIGHT11R, VOL_LIGHT12R, VOL_LIGHT13R, VOL_LIGHT14R, VOL_LIGHT15R,
         VOL_LIGHT16R, VOL_LIGHT17R, VOL_LIGHT18R, VOL_LIGHT19R, VOL_LIGHT20R,
+        OVERSAMPLE_LIGHT,
         NUM_LIGHTS
     };
 
     bool applyFilters = true; // Filter out DC is on by default
 
-    // Initialize Butterworth filter for oversampling
-    SimpleShaper shaperL;  // Instance of the oversampling and shaping processor
-    SimpleShaper shaperR;  // Instance of the oversampling and shaping processor
-    Filter6PButter butterworthFilter;  // Butterworth filter instance
-    bool isSupersamplingEnabled = false;  // Enable supersampling is off by default
+    // Output saturator, run inside a halfband-oversampled block when driven hard
+    DuckOversampledSaturator saturatorL;
+    DuckOversampledSaturator saturatorR;
+    int oversamplingFactor = 1;  // 1 = off, 2 or 4 = oversample above the clean threshold
+
+    // Expander bus for chaining ducks into one shared compressor and output stage
+    DuckBus duckBus;
 
     //for tracking the mute state of each channel
     bool muteLatch[7] = {false,false,false,false,false,false,false};
@@ -177,8 +149,11 @@ struct PressedDuck : Module {
         // Save the state of mutedSideDucks as a boolean
         json_object_set_new(rootJ, "mutedSideDucks", json_boolean(mutedSideDucks));
 
-        // Save the state of isSupersamplingEnabled as a boolean
-        json_object_set_new(rootJ, "isSupersamplingEnabled", json_boolean(isSupersamplingEnabled));
+        // Save the output oversampling factor
+        json_object_set_new(rootJ, "oversamplingFactor", json_integer(oversamplingFactor));
+
+        // Save whether this duck sends its mix to the duck on its right
+        json_object_set_new(rootJ, "busSend", json_boolean(duckBus.sendEnabled));
 
         // Save transitionTime
         json_object_set_new(rootJ, "transitionTime", json_real(transitionTime));
@@ -227,10 +202,20 @@ struct PressedDuck : Module {
             mutedSideDucks = json_is_true(mutedSideDucksJ);
         }
 
-        // Load the state of isSupersamplingEnabled
+        // Load the output oversampling factor, falling back to the old supersampling toggle
+        json_t* oversamplingFactorJ = json_object_get(rootJ, "oversamplingFactor");
         json_t* isSupersamplingEnabledJ = json_object_get(rootJ, "isSupersamplingEnabled");
-        if (isSupersamplingEnabledJ) {
-            isSupersamplingEnabled = json_is_true(isSupersamplingEnabledJ);
+        if (oversamplingFactorJ) {
+            int factor = json_integer_value(oversamplingFactorJ);
+            oversamplingFactor = (factor == 2 || factor == 4) ? factor : 1;
+        } else if (isSupersamplingEnabledJ) {
+            oversamplingFactor = json_is_true(isSupersamplingEnabledJ) ? 2 : 1;
+        }
+
+        // Load the expander bus send state
+        json_t* busSendJ = json_object_get(rootJ, "busSend");
+        if (busSendJ) {
+            duckBus.sendEnabled = json_is_true(busSendJ);
         }
 
         // Load transitionTime
@@ -306,8 +291,6 @@ struct PressedDuck : Module {
     float volTotalR = 1.0f;
 
     // Arrays to hold last computed values for differentiation
-    float lastOutputL = 0.0f;
-    float lastOutputR = 0.0f;
     float sideEnvelopeL = 0.0f;
     float sideEnvelopeR = 0.0f;
     float sideEnvelope = 0.0f;
@@ -481,6 +464,9 @@ struct PressedDuck : Module {
         transitionSamples = transitionTime * 0.001f * sampleRate;
         hpfL.setCutoffFrequency(sampleRate, 30.0f);
         hpfR.setCutoffFrequency(sampleRate, 30.0f);
+        saturatorL.setSampleRate(sampleRate);
+        saturatorR.setSampleRate(sampleRate);
+        duckBus.attach(this);
      }
 
     void onSampleRateChange() override {
@@ -488,6 +474,15 @@ struct PressedDuck : Module {
          transitionSamples = transitionTime * 0.001f * sampleRate;
          hpfL.setCutoffFrequency(sampleRate, 30.0f);
          hpfR.setCutoffFrequency(sampleRate, 30.0f);
+         saturatorL.setSampleRate(sampleRate);
+         saturatorR.setSampleRate(sampleRate);
+    }
+
+    void onExpanderChange(const ExpanderChangeEvent& e) override {
+        // A new left neighbour must not inherit the old one's bus frame
+        if (e.side == 0) {
+            duckBus.reset();
+        }
     }
 
     void onReset(const ResetEvent& e) override {
@@ -518,6 +513,8 @@ struct PressedDuck : Module {
 			cachedMasterVol = params[MASTER_VOL].getValue();
 			cachedMasterVolAtt = params[MASTER_VOL_ATT].getValue();
 			transitionSamples = transitionTime * 0.001f * sampleRate;
+			saturatorL.setFactor(oversamplingFactor);
+			saturatorR.setFactor(oversamplingFactor);
 		}
 		uiUpdateCounter = (uiUpdateCounter + 1) % UI_UPDATE_DIVIDER;
 
@@ -552,7 +549,7 @@ struct PressedDuck : Module {
 
 		// Early exit if nothing connected
 		bool sideConnected = inputs[SIDECHAIN_INPUT_L].isConnected() || inputs[SIDECHAIN_INPUT_R].isConnected();
-		if (firstConnectedChannel == -1 && !sideConnected) {
+		if (firstConnectedChannel == -1 && !sideConnected && !duckBus.isLinked(this)) {
 			for (int k = 0; k < 6; ++k) {
 				filteredEnvelopeL[k] = 0.0f;
 				filteredEnvelopeR[k] = 0.0f;
@@ -855,6 +852,30 @@ struct PressedDuck : Module {
             muteLatch[6] = false;
         }
 
+        // Merge with the expander bus; a sending duck stops here and leaves the
+        // compression and output stage to the master on its right
+        DuckBusFrame localFrame;
+        for (int i = 0; i < 6; i++) {
+            localFrame.mixL += inputL[i];
+            localFrame.mixR += inputR[i];
+        }
+        localFrame.envL = compressionAmountL;
+        localFrame.envR = compressionAmountR;
+        localFrame.inputCount = inputCount;
+
+        DuckBusFrame busFrame = duckBus.merge(this, localFrame);
+        if (duckBus.forward(this, busFrame)) {
+            pressTotalL = pressTotalR = 0.0f;
+            distortTotalL = distortTotalR = 0.0f;
+            volTotalL = volTotalR = 0.0f;
+            outputs[AUDIO_OUTPUT_L].setVoltage(0.0f);
+            outputs[AUDIO_OUTPUT_R].setVoltage(0.0f);
+            return;
+        }
+        compressionAmountL = busFrame.envL;
+        compressionAmountR = busFrame.envR;
+        inputCount = busFrame.inputCount;
+
         float sideChain=0.f;
         if (sideConnected) sideChain = 1.f;
         compressionAmountL = compressionAmountL/((inputCount+sideChain)*5.0f); //divide by the expected ceiling
@@ -876,14 +897,10 @@ struct PressedDuck : Module {
 
         // MIX the channels scaled by compression
         if (compressionAmountL > 0.0f && inputCount > 0.0f) {
-            for (int i = 0; i < 6; i++) {
-                mixL += inputL[i] * pressTotalL;
-            }
+            mixL = busFrame.mixL * pressTotalL;
         }
         if (compressionAmountR > 0.0f && inputCount > 0.0f) {
-            for (int i = 0; i < 6; i++) {
-                mixR += inputR[i] * pressTotalR;
-            }
+            mixR = busFrame.mixR * pressTotalR;
         }
 
 		// Side processing and envelope calculation
@@ -998,14 +1015,12 @@ struct PressedDuck : Module {
         distortTotalR = distortTotalR * decayRate +log1p(fmax(mixR-35.f, 0.0f)) * (35.0f / log1p(35)) * (1.0f - decayRate);
 
 
-        // Apply ADAA
+        // Apply ADAA saturation, oversampled when driven past the clean threshold
         float maxHeadRoom = 46.f; //1.314*35 exceeding this number results in strange wavefolding due to the polytanh bad fit beyond this point
         mixL = clamp(mixL, -maxHeadRoom, maxHeadRoom);
         mixR = clamp(mixR, -maxHeadRoom, maxHeadRoom);
-        mixL = applyADAA(mixL/35.f, lastOutputL, sampleRate); //35 is 7x5v
-        mixR = applyADAA(mixR/35.f, lastOutputR, sampleRate);
-        lastOutputL = mixL;
-        lastOutputR = mixR;
+        mixL = saturatorL.process(mixL/35.f); //35 is 7x5v
+        mixR = saturatorR.process(mixR/35.f);
 
         // Set outputs
         float masterVol = cachedMasterVol;
@@ -1023,36 +1038,11 @@ struct PressedDuck : Module {
         volTotalR = volTotalR * decayRate + fabs(outputR) * (1.0f - decayRate);
 
 
-        if (isSupersamplingEnabled) {
-            // Use the oversampling shaper for the signal
-            outputL = shaperL.process(outputL);
-            outputR = shaperR.process(outputR);
-        }
-
         outputs[AUDIO_OUTPUT_L].setVoltage(outputL);
         outputs[AUDIO_OUTPUT_R].setVoltage(outputR);
 
     }
 
-    float applyADAA(float input, float lastInput, float sampleRate) {
-        float delta = input - lastInput;
-        if (fabs(delta) > 1e-6) {
-            return (antiderivative(input) - antiderivative(lastInput)) / delta;
-        } else {
-            return polyTanh(input);
-        }
-    }
-
-	float antiderivative(float x) {
-		float x2 = x * x;
-		return x2 * (0.5f - x2 * (1.0f/12.0f - x2 * (1.0f/45.0f - 17.0f/2520.0f * x2)));
-	}
-	
-	float polyTanh(float x) {
-		float x2 = x * x;
-		return x - x * x2 * (1.0f/3.0f - x2 * (2.0f/15.0f - 17.0f/315.0f * x2));
-	}
-	
 	float polySin(float x) {
 		float x2 = x * x;
 		return x - x * x2 * (1.0f/6.0f - x2 * (1.0f/120.0f - x2 / 5040.0f));
@@ -1250,6 +1240,9 @@ struct PressedDuckWidget : ModuleWidget {
         xPos += 1*sliderX; // Shift to the right of the last channel
         addOutput(createOutputCentered<ThemedPJ301MPort>(Vec(xPos, yPos), module, PressedDuck::AUDIO_OUTPUT_R));
 
+        // Oversampling activity light between the outputs
+        addChild(createLightCentered<TinyLight<YellowLight>>(Vec(xPos - 0.5f*sliderX, yPos), module, PressedDuck::OVERSAMPLE_LIGHT));
+
     }
 
     void addLightsAroundKnob(Module* module, float knobX, float knobY, int firstLightId, int numLights, float radius) {
@@ -1292,6 +1285,9 @@ struct PressedDuckWidget : ModuleWidget {
 		updateSegmentedLights(module, PressedDuck::FEED_LIGHT1R, module->distortTotalR, 100.0f, 20);
 		updateSegmentedLights(module, PressedDuck::VOL_LIGHT1, module->volTotalL, 10.0f, 20);
 		updateSegmentedLights(module, PressedDuck::VOL_LIGHT1R, module->volTotalR, 10.0f, 20);
+
+		module->lights[PressedDuck::OVERSAMPLE_LIGHT].setBrightness(
+			fmax(module->saturatorL.getOversamplingLevel(), module->saturatorR.getOversamplingLevel()));
 	}
 	
 	void updateSegmentedLights(PressedDuck* module, int startLightId, float totalValue, float maxValue, int numLights) {
@@ -1386,27 +1382,63 @@ struct PressedDuckWidget : ModuleWidget {
         mutedSideDucksItem->PressedDuckModule = PressedDuckModule;
         menu->addChild(mutedSideDucksItem);
 
-        // Supersampling menu item
-        struct SupersamplingMenuItem : MenuItem {
+        // Expander bus menu item
+        struct BusSendMenuItem : MenuItem {
             PressedDuck* PressedDuckModule;
+            void onAction(const event::Action& e) override {
+                // Toggle sending this duck's mix to the duck on the right
+                PressedDuckModule->duckBus.sendEnabled = !PressedDuckModule->duckBus.sendEnabled;
+            }
+            void step() override {
+                // Update the display to show a checkmark when the mode is active
+                rightText = PressedDuckModule->duckBus.sendEnabled ? "✔" : "";
+                MenuItem::step();
+            }
+        };
+
+        BusSendMenuItem* busSendItem = new BusSendMenuItem();
+        busSendItem->text = "Send Mix to Duck on the Right";
+        busSendItem->PressedDuckModule = PressedDuckModule;
+        menu->addChild(busSendItem);
+
+        int upstreamDucks = PressedDuckModule->duckBus.getUpstreamCount();
+        if (upstreamDucks > 0) {
+            menu->addChild(createMenuLabel(string::f("Bus master for %d chained duck%s", upstreamDucks, upstreamDucks > 1 ? "s" : "")));
+        }
+
+        // Output oversampling menu items
+        menu->addChild(createMenuLabel("Output Oversampling"));
+
+        struct OversamplingMenuItem : MenuItem {
+            PressedDuck* PressedDuckModule;
+            int factor;
 
             void onAction(const event::Action& e) override {
-                // Toggle the "Supersampling" mode
-                PressedDuckModule->isSupersamplingEnabled = !PressedDuckModule->isSupersamplingEnabled;
+                PressedDuckModule->oversamplingFactor = factor;
             }
 
             void step() override {
-                // Update the display to show a checkmark when the mode is active
-                rightText = PressedDuckModule->isSupersamplingEnabled ? "✔" : "";
+                // Update the display to show a checkmark on the active factor
+                rightText = (PressedDuckModule->oversamplingFactor == factor) ? "✔" : "";
                 MenuItem::step();
             }
         };
 
-        // Create the Supersampling menu item and add it to the menu
-        SupersamplingMenuItem* supersamplingItem = new SupersamplingMenuItem();
-        supersamplingItem->text = "Enable Supersampling";
-        supersamplingItem->PressedDuckModule = PressedDuckModule;
-        menu->addChild(supersamplingItem);
+        const std::pair<const char*, int> oversamplingOptions[] = {
+            { "Off (base-rate ADAA)", 1 },
+            { "2x when driven",       2 },
+            { "4x when driven",       4 },
+        };
+        // The clean path is delayed to match, so the latency is constant.
+        for (const auto& option : oversamplingOptions) {
+            OversamplingMenuItem* oversamplingItem = new OversamplingMenuItem();
+            oversamplingItem->text = option.first;
+            if (option.second > 1)
+                oversamplingItem->text += string::f(", +%d samples latency", DuckOversampledSaturator::latencyFor(option.second));
+            oversamplingItem->factor = option.second;
+            oversamplingItem->PressedDuckModule = PressedDuckModule;
+            menu->addChild(oversamplingItem);
+        }
 
         // Separator for visual grouping in the context menu
         menu->addChild(new MenuSeparator());
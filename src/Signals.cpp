@@ -13,11 +13,128 @@
 #include "rack.hpp"
 #include <array>
 #include <vector>
+#include <atomic>
 
 using namespace rack;
+using simd::float_4;
 
 float MAX_TIME = 10.0f; // Max window time in seconds
-int MAX_BUFFER_SIZE; // Buffer size will be set in the constructor based on the sample rate
+
+// Min/max decimation pyramid for one captured trace. Level k holds the
+// min and max of each run of 2^k samples, for the first BUCKETS runs, so
+// level k covers the first BUCKETS << k samples of a capture. Samples are
+// written one at a time as they are captured; the display draws from the
+// finest level that still covers its whole time window, which has between
+// BUCKETS/2 and BUCKETS runs across it -- at least one per display point,
+// so short peaks survive at any zoom.
+struct SignalsPyramid {
+    static constexpr int BUCKETS = 2048;
+    int levels = 1;
+    std::vector<float> minValues;   // [level * BUCKETS + bucket]
+    std::vector<float> maxValues;
+
+    // Enough levels to cover maxSamples
+    void resize(int maxSamples) {
+        levels = 1;
+        while ((BUCKETS << (levels - 1)) < maxSamples) levels++;
+        minValues.assign(levels * BUCKETS, 0.f);
+        maxValues.assign(levels * BUCKETS, 0.f);
+    }
+
+    void clear() {
+        std::fill(minValues.begin(), minValues.end(), 0.f);
+        std::fill(maxValues.begin(), maxValues.end(), 0.f);
+    }
+
+    // Store sample 'index' of the capture. The first sample of each run
+    // restarts that run, so a new capture needs no clearing.
+    void write(int index, float x) {
+        for (int k = 0; k < levels; k++) {
+            int bucket = index >> k;
+            if (bucket >= BUCKETS) continue;
+            int slot = k * BUCKETS + bucket;
+            if ((index & ((1 << k) - 1)) == 0) {
+                minValues[slot] = x;
+                maxValues[slot] = x;
+            } else {
+                minValues[slot] = std::min(minValues[slot], x);
+                maxValues[slot] = std::max(maxValues[slot], x);
+            }
+        }
+    }
+
+    // Finest level whose BUCKETS runs cover 'samples'
+    int levelFor(float samples) const {
+        int k = 0;
+        while (k < levels - 1 && (float)(BUCKETS << k) < samples) k++;
+        return k;
+    }
+};
+
+// The same pyramid for all 16 channels of a poly cable, stored as
+// structure-of-arrays: each run holds one float_4 per group of four
+// channels, so one sample of all channels is written with GROUPS vector
+// min/max operations per level.
+struct SignalsPolyPyramid {
+    static constexpr int BUCKETS = 1024;
+    static constexpr int GROUPS = 4;
+    int levels = 0;  // 0 until first used
+    std::vector<float_4> minValues;  // [(level * BUCKETS + bucket) * GROUPS + group]
+    std::vector<float_4> maxValues;
+
+    void resize(int maxSamples) {
+        levels = 1;
+        while ((BUCKETS << (levels - 1)) < maxSamples) levels++;
+        minValues.assign(levels * BUCKETS * GROUPS, float_4(0.f));
+        maxValues.assign(levels * BUCKETS * GROUPS, float_4(0.f));
+    }
+
+    void clear() {
+        std::fill(minValues.begin(), minValues.end(), float_4(0.f));
+        std::fill(maxValues.begin(), maxValues.end(), float_4(0.f));
+    }
+
+    // Clear slots [from, to) of both arrays, for spreading a clear over
+    // several samples. Returns the new position.
+    size_t clearPartial(size_t from, size_t to) {
+        to = std::min(to, minValues.size());
+        std::fill(minValues.begin() + from, minValues.begin() + to, float_4(0.f));
+        std::fill(maxValues.begin() + from, maxValues.begin() + to, float_4(0.f));
+        return to;
+    }
+
+    void write(int index, const float_4* x, int groups) {
+        for (int k = 0; k < levels; k++) {
+            int bucket = index >> k;
+            if (bucket >= BUCKETS) continue;
+            int slot = (k * BUCKETS + bucket) * GROUPS;
+            if ((index & ((1 << k) - 1)) == 0) {
+                for (int g = 0; g < groups; g++) {
+                    minValues[slot + g] = x[g];
+                    maxValues[slot + g] = x[g];
+                }
+            } else {
+                for (int g = 0; g < groups; g++) {
+                    minValues[slot + g] = simd::fmin(minValues[slot + g], x[g]);
+                    maxValues[slot + g] = simd::fmax(maxValues[slot + g], x[g]);
+                }
+            }
+        }
+    }
+
+    int levelFor(float samples) const {
+        int k = 0;
+        while (k < levels - 1 && (float)(BUCKETS << k) < samples) k++;
+        return k;
+    }
+
+    float minAt(int level, int bucket, int channel) const {
+        return minValues[(level * BUCKETS + bucket) * GROUPS + channel / 4][channel % 4];
+    }
+    float maxAt(int level, int bucket, int channel) const {
+        return maxValues[(level * BUCKETS + bucket) * GROUPS + channel / 4][channel % 4];
+    }
+};
 
 struct Signals : Module {
     enum ParamId {
@@ -42,15 +159,14 @@ struct Signals : Module {
     };
 
     float currentTimeSetting = 1.0f;
-    std::array<std::vector<float>, 6> envelopeBuffers;
-    std::array<std::vector<float>, 6> displayBuffers; // persistent display copy
+    int maxBufferSize = 1;  // samples in MAX_TIME at the current sample rate
+    std::array<SignalsPyramid, 6> envelopeBuffers;  // capture in progress
+    std::array<SignalsPyramid, 6> displayBuffers;   // persistent display copy
     std::array<int, 6> writeIndices = {}; 
     float lastInputs[6] = {};
     std::array<float, 6> lastTriggerTime = {}; 
     bool retriggerEnabled = false; 
     bool retriggerToggleProcessed = false;
-    double displayUpdateTime = 0.1; 
-    double timeSinceLastUpdate = 0.0;
     float scopeInput[6] = {0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f};
     int scopeChannels[6] = {0, 0, 0, 0, 0, 0};  // Number of polyphonic channels for Scope inputs
     int activeScopeChannel[6] = {-1, -1, -1, -1, -1, -1};  // Stores the number of the previous active channel for the Scope
@@ -61,13 +177,39 @@ struct Signals : Module {
     //non-glitchy display refreshing
     bool waitingForTrigger[6] = {true, true, true, true, true, true};
     bool displayReady[6] = {false, false, false, false, false, false};
+    uint32_t displaySeq[6] = {};  // bumped whenever displayBuffers[i] changes
+
+    // Polyphonic overlay: every channel of input 1 is captured together into
+    // SoA pyramids and drawn overlaid in one display. All channels share a
+    // write index; in retrigger mode the capture starts on the first rising
+    // zero crossing of any channel, and each channel's own first crossing
+    // is recorded as its offset into the capture, so every trace is drawn
+    // from its own trigger point. Trigger tests run four channels at a time.
+    // The pyramids are sized on the UI thread by setPolyOverlay() before the
+    // flag is raised, so process() never allocates them.
+    std::atomic<bool> polyOverlay{false};
+    SignalsPolyPyramid polyEnvelope;    // capture in progress
+    SignalsPolyPyramid polyDisplay;     // last complete capture
+    int polyChannels = 0;
+    int polyWriteIndex = 0;
+    int polyCaptureWindow = 1;
+    bool polyWaiting = true;
+    int polyFoundCount = 0;             // channels triggered in this capture
+    int polyLatestOffset = 0;
+    float_4 polyLast[SignalsPolyPyramid::GROUPS];
+    float_4 polyFound[SignalsPolyPyramid::GROUPS];    // lane mask
+    float_4 polyOffset[SignalsPolyPyramid::GROUPS];   // trigger offset per lane
+    int polyDisplayOffset[16] = {};
+    int polyDisplayWindow = 1;
+    uint32_t polyDisplaySeq = 0;
+    size_t polyClearPos = 0;            // polyDisplay slots cleared since the channel count changed
+    static constexpr size_t POLY_CLEAR_BATCH = 2048;
     int samplesSinceTrigger[6] = {0, 0, 0, 0, 0, 0};
 
-    FramebufferWidget* fbWidget = nullptr;
-
     json_t* dataToJson() override {
         json_t* rootJ = json_object();
         json_object_set_new(rootJ, "retriggerEnabled", json_boolean(retriggerEnabled));
+        json_object_set_new(rootJ, "polyOverlay", json_boolean(polyOverlay));
         return rootJ;
     }
 
@@ -76,6 +218,10 @@ struct Signals : Module {
         if (retriggerEnabledJ) {
             retriggerEnabled = json_is_true(retriggerEnabledJ);
         }
+        json_t* polyOverlayJ = json_object_get(rootJ, "polyOverlay");
+        if (polyOverlayJ) {
+            setPolyOverlay(json_is_true(polyOverlayJ));
+        }
     }
 
     Signals() {
@@ -86,32 +232,149 @@ struct Signals : Module {
         configParam(RESET_PARAM, 0.f, 1.f, 0.f, "Reset displays");
 
         lastTriggerTime.fill(0.0f);
-        MAX_BUFFER_SIZE = int(static_cast<int>(APP->engine->getSampleRate() * MAX_TIME));
+        resizeBuffers(APP->engine->getSampleRate());
+    }
+
+    void onSampleRateChange() override {
+        resizeBuffers(APP->engine->getSampleRate());
+    }
 
+    void resizeBuffers(float sampleRate) {
+        maxBufferSize = std::max(1, int(sampleRate * MAX_TIME));
         for (auto &buffer : envelopeBuffers) {
-            buffer.resize(MAX_BUFFER_SIZE, 0.0f);
+            buffer.resize(maxBufferSize);
         }
         for (auto &buffer : displayBuffers) {
-            buffer.resize(MAX_BUFFER_SIZE, 0.0f);
-        }        
+            buffer.resize(maxBufferSize);
+        }
+        if (polyDisplay.levels > 0) {
+            resizePolyBuffers();
+        }
     }
 
-    void onSampleRateChange() override {
-        MAX_BUFFER_SIZE = int(static_cast<int>(APP->engine->getSampleRate() * MAX_TIME));
-    
-        for (auto &buffer : envelopeBuffers) {
-            buffer.resize(MAX_BUFFER_SIZE, 0.0f);
+    // A retrigger capture may run up to twice the window while it waits
+    // for every channel's crossing.
+    void resizePolyBuffers() {
+        polyEnvelope.resize(2 * maxBufferSize);
+        polyDisplay.resize(2 * maxBufferSize);
+        polyClearPos = polyDisplay.minValues.size();
+        resetPolyCapture();
+    }
+
+    // UI thread: the pyramids are allocated the first time the overlay is
+    // enabled, before process() can see the flag. Later sample rate changes
+    // resize them from onSampleRateChange(), while the engine is paused.
+    void setPolyOverlay(bool enabled) {
+        if (enabled && polyDisplay.levels == 0) {
+            resizePolyBuffers();
         }
-        for (auto &buffer : displayBuffers) {
-            buffer.resize(MAX_BUFFER_SIZE, 0.0f);
+        polyOverlay = enabled;
+    }
+
+    void resetPolyCapture() {
+        for (int g = 0; g < SignalsPolyPyramid::GROUPS; g++) {
+            polyLast[g] = float_4(0.f);
+            polyFound[g] = float_4(0.f);
+            polyOffset[g] = float_4(0.f);
+        }
+        std::fill(polyDisplayOffset, polyDisplayOffset + 16, 0);
+        polyWriteIndex = 0;
+        polyWaiting = true;
+        polyFoundCount = 0;
+        polyLatestOffset = 0;
+        polyDisplaySeq++;
+    }
+
+    void processPolyOverlay(int window) {
+        if (polyDisplay.levels == 0) return;
+
+        // A channel count change clears the display a batch per sample;
+        // capture resumes once it is blank
+        int channels = inputs[ENV1_INPUT].isConnected() ? inputs[ENV1_INPUT].getChannels() : 0;
+        if (channels != polyChannels) {
+            polyChannels = channels;
+            polyClearPos = 0;
+            resetPolyCapture();
+        }
+        if (polyClearPos < polyDisplay.minValues.size()) {
+            polyClearPos = polyDisplay.clearPartial(polyClearPos, polyClearPos + POLY_CLEAR_BATCH);
+            polyDisplaySeq++;
+            return;
+        }
+        if (channels == 0) return;
+
+        int groups = (channels + 3) / 4;
+        float_4 x[SignalsPolyPyramid::GROUPS];
+        float_4 rising[SignalsPolyPyramid::GROUPS];
+        int anyRising = 0;
+        for (int g = 0; g < groups; g++) {
+            x[g] = simd::clamp(inputs[ENV1_INPUT].getPolyVoltageSimd<float_4>(g * 4), -10.f, 10.f);
+            float_4 lane = float_4(g * 4) + float_4(0.f, 1.f, 2.f, 3.f);
+            rising[g] = (x[g] > 0.f) & (polyLast[g] <= 0.f) & (lane < float_4(channels));
+            anyRising |= simd::movemask(rising[g]);
+            polyLast[g] = x[g];
+        }
+
+        if (!retriggerEnabled) {
+            // Free running: all channels wrap together, no offsets
+            if (polyWriteIndex >= window) polyWriteIndex = 0;
+            polyDisplay.write(polyWriteIndex, x, groups);
+            polyWriteIndex++;
+            polyDisplayWindow = window;
+            std::fill(polyDisplayOffset, polyDisplayOffset + 16, 0);
+            polyDisplaySeq++;
+            return;
+        }
+
+        if (polyWaiting) {
+            if (!anyRising) return;
+            polyWaiting = false;
+            polyWriteIndex = 0;
+            polyCaptureWindow = window;
+            polyFoundCount = 0;
+            polyLatestOffset = 0;
+            for (int g = 0; g < SignalsPolyPyramid::GROUPS; g++) {
+                polyFound[g] = float_4(0.f);
+                polyOffset[g] = float_4(0.f);
+            }
+        }
+
+        polyEnvelope.write(polyWriteIndex, x, groups);
+        if (anyRising) {
+            float_4 index = float_4((float)polyWriteIndex);
+            for (int g = 0; g < groups; g++) {
+                float_4 newly = rising[g] & ~polyFound[g];
+                int newMask = simd::movemask(newly);
+                if (!newMask) continue;
+                polyOffset[g] = simd::ifelse(newly, index, polyOffset[g]);
+                polyFound[g] |= newly;
+                polyFoundCount += __builtin_popcount(newMask);
+                polyLatestOffset = polyWriteIndex;
+            }
+        }
+        polyWriteIndex++;
+
+        // Done once every channel has a full window after its trigger, or
+        // after two windows (channels that never crossed start at 0)
+        bool complete = (polyFoundCount >= channels && polyWriteIndex >= polyLatestOffset + polyCaptureWindow)
+                        || polyWriteIndex >= 2 * polyCaptureWindow;
+        if (complete) {
+            std::swap(polyEnvelope, polyDisplay);
+            for (int c = 0; c < 16; c++) {
+                polyDisplayOffset[c] = (int)polyOffset[c / 4][c % 4];
+            }
+            polyDisplayWindow = polyCaptureWindow;
+            polyDisplaySeq++;
+            polyWaiting = true;
         }
     }
 
     // Clears all buffers and resets capture state for all channels.
     void resetAllChannels() {
         for (int i = 0; i < 6; ++i) {
-            std::fill(envelopeBuffers[i].begin(), envelopeBuffers[i].end(), 0.f);
-            std::fill(displayBuffers[i].begin(), displayBuffers[i].end(), 0.f);
+            envelopeBuffers[i].clear();
+            displayBuffers[i].clear();
+            displaySeq[i]++;
             writeIndices[i] = 0;
             lastInputs[i] = 0.f;
             lastTriggerTime[i] = 0.f;
@@ -133,7 +396,7 @@ struct Signals : Module {
         }
         range = clamp(range, 0.000001f, .9999f);
     
-        int currentBufferSize = std::max(1, int((MAX_BUFFER_SIZE / MAX_TIME) * currentTimeSetting * range));
+        int currentBufferSize = std::max(1, int((maxBufferSize / MAX_TIME) * currentTimeSetting * range));
     
         // --- Scan inputs ---
         for (int i = 0; i < 6; i++) {
@@ -157,8 +420,9 @@ struct Signals : Module {
             // --- Inactive channel: zero buffers ONLY when state changes ---
             if (activeScopeChannel[i] == -1) {
                 if (channelStateChanged) {
-                    std::fill(envelopeBuffers[i].begin(), envelopeBuffers[i].end(), 0.f);
-                    std::fill(displayBuffers[i].begin(), displayBuffers[i].end(), 0.f);
+                    envelopeBuffers[i].clear();
+                    displayBuffers[i].clear();
+                    displaySeq[i]++;
                     writeIndices[i] = 0;
                     lastInputs[i] = 0.f;
                     lastTriggerTime[i] = 0.f;
@@ -177,8 +441,9 @@ struct Signals : Module {
             if (currentChannelMax - diffBetween <= 0) {
                 // This channel index doesn't exist in the poly cable
                 if (channelStateChanged) {
-                    std::fill(envelopeBuffers[i].begin(), envelopeBuffers[i].end(), 0.f);
-                    std::fill(displayBuffers[i].begin(), displayBuffers[i].end(), 0.f);
+                    envelopeBuffers[i].clear();
+                    displayBuffers[i].clear();
+                    displaySeq[i]++;
                     writeIndices[i] = 0;
                     lastInputs[i] = 0.f;
                 }
@@ -200,7 +465,9 @@ struct Signals : Module {
             scopeInput[i] = clamp(inputs[ENV1_INPUT + activeScopeChannel[i]].getPolyVoltage(diffBetween), -10.f, 10.f);
             lastTriggerTime[i] += args.sampleTime;
         
-            if (retriggerEnabled) {
+            if (polyOverlay) {
+                // Captured by processPolyOverlay()
+            } else if (retriggerEnabled) {
                 // --- Retrigger / capture ---
                 if (waitingForTrigger[i]) {
                     if (scopeInput[i] > 0.f && lastInputs[i] <= 0.f) {
@@ -211,7 +478,7 @@ struct Signals : Module {
                     }
                 } else {
                     if (writeIndices[i] < currentBufferSize) {
-                        envelopeBuffers[i][writeIndices[i]] = scopeInput[i];
+                        envelopeBuffers[i].write(writeIndices[i], scopeInput[i]);
                     }
                     writeIndices[i] = (writeIndices[i] + 1) % currentBufferSize;
                     samplesSinceTrigger[i]++;
@@ -221,20 +488,18 @@ struct Signals : Module {
                         waitingForTrigger[i] = true;
                         samplesSinceTrigger[i] = 0;
         
-                        // Copy current capture into display buffer
-                        std::copy(
-                            envelopeBuffers[i].begin(),
-                            envelopeBuffers[i].begin() + currentBufferSize,
-                            displayBuffers[i].begin()
-                        );
+                        // Show the finished capture; the old display
+                        // buffer becomes the next capture buffer
+                        std::swap(envelopeBuffers[i], displayBuffers[i]);
+                        displaySeq[i]++;
                     }
                 }
             } else {
                 // --- Free-running continuous update ---
                 // Write to current position BEFORE incrementing
                 if (writeIndices[i] < currentBufferSize) {
-                    envelopeBuffers[i][writeIndices[i]] = scopeInput[i];
-                    displayBuffers[i][writeIndices[i]] = scopeInput[i];
+                    displayBuffers[i].write(writeIndices[i], scopeInput[i]);
+                    displaySeq[i]++;
                 }
                 writeIndices[i] = (writeIndices[i] + 1) % currentBufferSize;
         
@@ -252,6 +517,10 @@ struct Signals : Module {
         }
 
     
+        if (polyOverlay) {
+            processPolyOverlay(currentBufferSize);
+        }
+
         // --- Retrigger toggle ---
         if (params[TRIGGER_ON_PARAM].getValue() > 0.5f && !retriggerToggleProcessed) {
             retriggerEnabled = !retriggerEnabled;
@@ -278,13 +547,6 @@ struct Signals : Module {
         }
     
         lights[TRIGGER_ON_LIGHT].setBrightness(retriggerEnabled ? 1.0f : 0.0f);
-    
-        // --- Refresh display ---
-        timeSinceLastUpdate += args.sampleTime;
-        if (timeSinceLastUpdate >= displayUpdateTime) {
-            timeSinceLastUpdate = 0.0;
-            if (fbWidget) fbWidget->dirty = true;
-        }
     }
 
 };
@@ -294,7 +556,23 @@ struct WaveformDisplay : TransparentWidget {
     int channelId;
     NVGcolor waveformColor;
 
-    WaveformDisplay(NVGcolor color) : waveformColor(color) {}
+    // Vertex cache: rebuilt only when the module publishes a new snapshot
+    // or the view changes. WaveformLayer repaints its framebuffer at the
+    // same moments, so an unchanged trace is not stroked again at all.
+    std::vector<Vec> points;
+    uint32_t drawnSeq = 0;
+    float drawnRangeParam = -1.f;
+    float drawnTimeSetting = -1.f;
+    int drawnBufferSize = -1;
+    bool drawnActive = false;
+    bool drawnOverlay = false;
+    Vec drawnSize;
+
+    static constexpr int DISPLAY_SAMPLES = 1024;
+
+    WaveformDisplay(NVGcolor color) : waveformColor(color) {
+        points.reserve(2 + 2 * DISPLAY_SAMPLES);
+    }
 
     // Draws a static preview waveform when no module is loaded (library / browser).
     // Each channel gets a distinct waveform shape so the display looks lively.
@@ -342,65 +620,205 @@ struct WaveformDisplay : TransparentWidget {
         nvgStroke(args.vg);
     }
 
-    void drawWaveform(const DrawArgs& args) {
-        if (!module) {
-            drawDummyWaveform(args);
-            return;
+    // Rebuild the vertices if the module published a new snapshot or the
+    // view changed; returns true when the trace needs repainting.
+    bool updatePoints() {
+        // Always show last valid waveform if available
+        const SignalsPyramid& buffer = module->displayBuffers[channelId];
+        if (buffer.minValues.empty()) return false;
+
+        float rangeParam = module->params[Signals::RANGE_PARAM].getValue();
+        bool active = module->activeScopeChannel[channelId] > -1;
+        if (!points.empty()
+            && drawnSeq == module->displaySeq[channelId]
+            && drawnRangeParam == rangeParam
+            && drawnTimeSetting == module->currentTimeSetting
+            && drawnBufferSize == module->maxBufferSize
+            && drawnActive == active
+            && drawnOverlay == module->polyOverlay
+            && drawnSize.equals(box.size)) {
+            return false;
         }
+        drawnSeq = module->displaySeq[channelId];
+        drawnRangeParam = rangeParam;
+        drawnTimeSetting = module->currentTimeSetting;
+        drawnBufferSize = module->maxBufferSize;
+        drawnActive = active;
+        drawnOverlay = module->polyOverlay;
+        drawnSize = box.size;
+        buildPoints(buffer, rangeParam, active);
+        return true;
+    }
 
-        // Always show last valid waveform if available
-        const auto& buffer = module->displayBuffers[channelId];
-        if (buffer.empty()) return;
+    void drawWaveform(const DrawArgs& args) {
+        // The overlay display takes over the whole column
+        if (module->polyOverlay || points.empty()) return;
+
+        // Draw the waveform
+        nvgBeginPath(args.vg);
+        nvgStrokeWidth(args.vg, 1.8f);
+        nvgStrokeColor(args.vg, waveformColor);        
+        nvgMoveTo(args.vg, points[0].x, points[0].y);
+        for (size_t i = 1; i < points.size(); ++i) { // Start from 1 to avoid duplicating the first point
+            nvgLineTo(args.vg, points[i].x, points[i].y);
+        }
+        nvgStroke(args.vg);
+    }
 
-        float range = pow(module->params[Signals::RANGE_PARAM].getValue(), 3.0f) / (MAX_TIME / module->currentTimeSetting);
+    // Fill 'points' from the display pyramid, reusing its storage
+    void buildPoints(const SignalsPyramid& buffer, float rangeParam, bool active) {
+        float range = rangeParam * rangeParam * rangeParam / (MAX_TIME / module->currentTimeSetting);
+        float windowSamples = (module->maxBufferSize - 1) * range + 1;
+        int level = buffer.levelFor(windowSamples);
+        const float* minValues = &buffer.minValues[level * SignalsPyramid::BUCKETS];
+        const float* maxValues = &buffer.maxValues[level * SignalsPyramid::BUCKETS];
     
-        int displaySamples = 1024;
-        std::vector<Vec> points;
+        const int displaySamples = DISPLAY_SAMPLES;
+        points.clear();
     
         float firstSampleY = box.size.y;
-        if ((module->activeScopeChannel[channelId] > -1) && !buffer.empty()) {
-            firstSampleY = box.size.y * (1.0f - (buffer.front() / 15.0f));
+        if (active) {
+            firstSampleY = box.size.y * (1.0f - (minValues[0] / 15.0f));
         }
     
         points.push_back(Vec(0, box.size.y));
         points.push_back(Vec(0, firstSampleY));
     
+        // Each display point spans the runs between its sample and the
+        // next; draw the min and max of those, nearer one first. Zoomed in
+        // past one run per point, neighbouring points share a run.
         for (int i = 0; i < displaySamples; ++i) {
-            // Ensure bufferIndex does not exceed buffer.size() - 1
-            int bufferIndex = int(i * ((buffer.size() - 1) * range + 1) / (displaySamples - 1));
-            bufferIndex = clamp(bufferIndex, 0, static_cast<int>(buffer.size()) - 1);
+            int bucketStart = int(i * windowSamples / (displaySamples - 1)) >> level;
+            bucketStart = std::min(bucketStart, SignalsPyramid::BUCKETS - 1);
+            int bucketEnd = int((i + 1) * windowSamples / (displaySamples - 1)) >> level;
+            bucketEnd = clamp(bucketEnd, bucketStart + 1, SignalsPyramid::BUCKETS);
     
             float x = (static_cast<float>(i) / (displaySamples - 1)) * box.size.x;
-            float y = box.size.y;
-            if ((module->activeScopeChannel[channelId] > -1 )) {
-                y = box.size.y * (1.0f - (buffer[bufferIndex] / 15.0f));
+            if (!active) {
+                points.push_back(Vec(x, box.size.y));
+                continue;
             }
-            points.push_back(Vec(x, y));
-        }
-    
-        // Draw the waveform
-        nvgBeginPath(args.vg);
-        nvgStrokeWidth(args.vg, 1.8f);
-        nvgStrokeColor(args.vg, waveformColor);        
-        nvgMoveTo(args.vg, points[0].x, points[0].y);
-        for (size_t i = 1; i < points.size(); ++i) { // Start from 1 to avoid duplicating the first point
-            nvgLineTo(args.vg, points[i].x, points[i].y);
+            float lo = minValues[bucketStart];
+            float hi = maxValues[bucketStart];
+            for (int b = bucketStart + 1; b < bucketEnd; ++b) {
+                lo = std::min(lo, minValues[b]);
+                hi = std::max(hi, maxValues[b]);
+            }
+            float yFirst  = box.size.y * (1.0f - (hi / 15.0f));
+            float ySecond = box.size.y * (1.0f - (lo / 15.0f));
+            float yPrev = points.back().y;
+            if (std::fabs(yPrev - ySecond) < std::fabs(yPrev - yFirst)) std::swap(yFirst, ySecond);
+            points.push_back(Vec(x, yFirst));
+            if (hi != lo) points.push_back(Vec(x, ySecond));
         }
-        nvgStroke(args.vg);
     }
 
 
+    // Only ever drawn into WaveformLayer's framebuffer: the preview when
+    // there is no module (library / browser), the live trace otherwise.
+    void draw(const DrawArgs& args) override {
+        if (!module) drawDummyWaveform(args);
+        else drawWaveform(args);
+    }
+};
+
+// One framebuffer per trace, repainted only when WaveformDisplay reports a
+// change. The live trace's cached image is composited on the light layer,
+// as the trace itself used to be, so it still shows in a dimmed room; the
+// library preview stays on the base layer.
+struct WaveformLayer : FramebufferWidget {
+    WaveformDisplay* display = nullptr;
+
+    void step() override {
+        if (display->module && display->updatePoints()) setDirty();
+        FramebufferWidget::step();
+    }
+
+    void draw(const DrawArgs& args) override {
+        if (!display->module) FramebufferWidget::draw(args);
+    }
+
     void drawLayer(const DrawArgs& args, int layer) override {
-        if (layer == 1) {
-            drawWaveform(args);
+        if (layer == 1 && display->module) FramebufferWidget::draw(args);
+        FramebufferWidget::drawLayer(args, layer);
+    }
+};
+
+// Overlays every channel of input 1, each from its own trigger point,
+// across the area of all six displays. Vertices are cached per channel
+// like WaveformDisplay's and rebuilt only for a new capture or view.
+struct PolyOverlayDisplay : TransparentWidget {
+    Signals* module = nullptr;
+
+    static constexpr int DISPLAY_SAMPLES = 512;
+    std::vector<Vec> points[16];
+    uint32_t drawnSeq = 0;
+    int drawnChannels = -1;
+    Vec drawnSize;
+
+    PolyOverlayDisplay() {
+        for (auto& p : points) p.reserve(2 * DISPLAY_SAMPLES);
+    }
+
+    void buildPoints(int channel) {
+        const SignalsPolyPyramid& buffer = module->polyDisplay;
+        int offset = module->polyDisplayOffset[channel];
+        float windowSamples = (float)module->polyDisplayWindow;
+        int level = buffer.levelFor(offset + windowSamples);
+        std::vector<Vec>& p = points[channel];
+        p.clear();
+
+        // Same min/max-per-column scheme as WaveformDisplay, starting at
+        // this channel's trigger (rounded to the run grid of 'level')
+        for (int i = 0; i < DISPLAY_SAMPLES; ++i) {
+            int bucketStart = int(offset + i * windowSamples / (DISPLAY_SAMPLES - 1)) >> level;
+            bucketStart = std::min(bucketStart, SignalsPolyPyramid::BUCKETS - 1);
+            int bucketEnd = int(offset + (i + 1) * windowSamples / (DISPLAY_SAMPLES - 1)) >> level;
+            bucketEnd = clamp(bucketEnd, bucketStart + 1, SignalsPolyPyramid::BUCKETS);
+
+            float lo = buffer.minAt(level, bucketStart, channel);
+            float hi = buffer.maxAt(level, bucketStart, channel);
+            for (int b = bucketStart + 1; b < bucketEnd; ++b) {
+                lo = std::min(lo, buffer.minAt(level, b, channel));
+                hi = std::max(hi, buffer.maxAt(level, b, channel));
+            }
+            float x = (static_cast<float>(i) / (DISPLAY_SAMPLES - 1)) * box.size.x;
+            float yFirst  = box.size.y * (1.0f - (hi / 15.0f));
+            float ySecond = box.size.y * (1.0f - (lo / 15.0f));
+            if (!p.empty() && std::fabs(p.back().y - ySecond) < std::fabs(p.back().y - yFirst)) {
+                std::swap(yFirst, ySecond);
+            }
+            p.push_back(Vec(x, yFirst));
+            if (hi != lo) p.push_back(Vec(x, ySecond));
         }
-        TransparentWidget::drawLayer(args, layer);
     }
 
-    void draw(const DrawArgs& args) override {
-        // Draw dummy waveform in the base layer when there is no module
-        // (library / browser preview). Live waveforms render in drawLayer(1).
-        if (!module) drawDummyWaveform(args);
+    void drawLayer(const DrawArgs& args, int layer) override {
+        if (layer == 1 && module && module->polyOverlay && module->polyDisplay.levels > 0) {
+            int channels = std::min(module->polyChannels, 16);
+            if (drawnSeq != module->polyDisplaySeq
+                || drawnChannels != channels
+                || !drawnSize.equals(box.size)) {
+                drawnSeq = module->polyDisplaySeq;
+                drawnChannels = channels;
+                drawnSize = box.size;
+                for (int c = 0; c < channels; ++c) buildPoints(c);
+            }
+
+            for (int c = 0; c < channels; ++c) {
+                const std::vector<Vec>& p = points[c];
+                if (p.empty()) continue;
+                nvgBeginPath(args.vg);
+                nvgStrokeWidth(args.vg, 1.2f);
+                nvgStrokeColor(args.vg, nvgHSLA(c / 16.f, 0.5f, 0.65f, 0xc0));
+                nvgMoveTo(args.vg, p[0].x, p[0].y);
+                for (size_t i = 1; i < p.size(); ++i) {
+                    nvgLineTo(args.vg, p[i].x, p[i].y);
+                }
+                nvgStroke(args.vg);
+            }
+        }
+        TransparentWidget::drawLayer(args, layer);
     }
 };
 
@@ -432,13 +850,11 @@ struct SignalsWidget : ModuleWidget {
         addParam(createParamCentered<TL1105>(mm2px(Vec(50, 19)), module, Signals::TRIGGER_ON_PARAM));
         addChild(createLightCentered<SmallLight<RedLight>>(mm2px(Vec(55, 19)), module, Signals::TRIGGER_ON_LIGHT));
 
+        // Each trace gets its own framebuffer (see WaveformLayer); the
+        // overlay draws on the light layer over this one.
         fbWidget = new FramebufferWidget();
         addChild(fbWidget);
 
-        if (module) {
-            module->fbWidget = fbWidget;
-        }
-
         NVGcolor colors[6] = {
             nvgRGB(0xa0, 0xa0, 0xa0), // Even Lighter Grey
             nvgRGB(0x90, 0x90, 0x90), // Lighter Grey
@@ -457,12 +873,46 @@ struct SignalsWidget : ModuleWidget {
             addOutput(createOutput<ThemedPJ301MPort>(Vec(148, yPos + 20), module, i));
 
             WaveformDisplay* display = new WaveformDisplay(colors[i]);
-            display->box.pos = Vec(39, yPos);
             display->box.size = Vec(104, 40); 
             display->module = module;
             display->channelId = i;
-            fbWidget->addChild(display);
+            WaveformLayer* layer = new WaveformLayer();
+            layer->box.pos = Vec(39, yPos);
+            layer->box.size = display->box.size;
+            layer->display = display;
+            layer->addChild(display);
+            addChild(layer);
         }
+
+        PolyOverlayDisplay* overlay = new PolyOverlayDisplay();
+        overlay->box.pos = Vec(39, initialYPos);
+        overlay->box.size = Vec(104, 5 * spacing + 40);
+        overlay->module = module;
+        fbWidget->addChild(overlay);
+    }
+
+    void appendContextMenu(Menu* menu) override {
+        ModuleWidget::appendContextMenu(menu);
+
+        Signals* signalsModule = dynamic_cast<Signals*>(this->module);
+        if (!signalsModule) return;
+
+        menu->addChild(new MenuSeparator());
+
+        struct PolyOverlayItem : MenuItem {
+            Signals* signalsModule;
+            void onAction(const event::Action& e) override {
+                signalsModule->setPolyOverlay(!signalsModule->polyOverlay);
+            }
+            void step() override {
+                rightText = signalsModule->polyOverlay ? "✔" : "";
+                MenuItem::step();
+            }
+        };
+        auto* polyOverlayItem          = new PolyOverlayItem();
+        polyOverlayItem->text          = "Polyphonic overlay (all channels of input 1)";
+        polyOverlayItem->signalsModule = signalsModule;
+        menu->addChild(polyOverlayItem);
     }
 };
 
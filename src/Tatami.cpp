@@ -12,6 +12,8 @@
 #include "rack.hpp"
 #include "plugin.hpp"
 using namespace rack;
+using simd::float_4;
+using simd::int32_4;
 
 template<typename T, size_t Size>
 class CircularBuffer {
@@ -75,9 +77,203 @@ float polyCos(float x) {
 }
 
 
+// float_4 versions of the above, wrapping with floor so all four lanes stay branch-free
+float_4 wrapToPi(float_4 x) {
+    const float pi = M_PI;
+    const float twoPi = 2.0f * pi;
+    x += pi;
+    x -= twoPi * simd::floor(x * (1.0f / twoPi)); // Wrap x to [0, 2*pi)
+    return x - pi;                                // Shift to [-pi, pi]
+}
+
+float_4 polySin(float_4 x) {
+    x = wrapToPi(x);
+    float_4 x2 = x * x;
+    float_4 x3 = x * x2;
+    float_4 x5 = x3 * x2;
+    float_4 x7 = x5 * x2;
+    float_4 x9 = x7 * x2;
+    return x - x3 / 6.0f + x5 / 120.0f - x7 / 5040.0f + x9 / 362880.0f;
+}
+
+float_4 polyCos(float_4 x) {
+    x = wrapToPi(x);
+    float_4 x2 = x * x;
+    float_4 x4 = x2 * x2;
+    float_4 x6 = x4 * x2;
+    float_4 x8 = x6 * x2;
+    return 1.0f - x2 / 2.0f + x4 / 24.0f - x6 / 720.0f + x8 / 40320.0f;
+}
+
+
+// Per-lane blend weights for the four fold regions:
+//   0..1  logistic -> sin(x)
+//   1..2  sin(x)   -> sin(x^n), n = 1..1.5
+//   2..3  sin(x^n) -> logistic
+// Each weight is a triangular window over the shape value, so the regions
+// cross over without branching and four channels can sit in different regions.
+struct TatamiFoldBlend {
+    float_4 wLogistic;  // weight of the logistic curve
+    float_4 wSin;       // weight of sin(x)
+    float_4 wPowSin;    // weight of sin(sgn(x)*|x|^n)
+    float_4 power;      // n
+    bool anyLogistic = true;
+    bool anyPowSin = true;
+
+    void setShape(float_4 s) {
+        wLogistic = simd::clamp(1.f - s, 0.f, 1.f) + simd::clamp(s - 2.f, 0.f, 1.f);
+        wSin = simd::clamp(1.f - simd::fabs(s - 1.f), 0.f, 1.f);
+        wPowSin = simd::clamp(1.f - simd::fabs(s - 2.f), 0.f, 1.f);
+        power = 1.f + 0.5f * simd::clamp(s - 1.f, 0.f, 1.f);
+
+        // Let whole blocks skip the exp/log work when no lane needs it
+        anyLogistic = simd::movemask(wLogistic > 0.f) != 0;
+        anyPowSin = simd::movemask(wPowSin > 0.f) != 0;
+    }
+};
+
+
+// Uniform table with Catmull-Rom interpolation. One guard point below x0 and
+// two above x1 let every lookup read four neighbours without bounds checks.
+template <int N>
+struct TatamiCubicTable {
+    float data[N + 3];
+    float x0 = 0.f;
+    float invStep = 1.f;
+
+    template <typename F>
+    void build(F fn, float xMin, float xMax) {
+        x0 = xMin;
+        float step = (xMax - xMin) / N;
+        invStep = 1.f / step;
+        for (int j = 0; j < N + 3; j++) {
+            data[j] = fn(xMin + (j - 1) * step);
+        }
+    }
+
+    // x is clamped to [x0, x0 + N*step]
+    float eval(float x) const {
+        float u = clamp((x - x0) * invStep, 0.f, N - 1e-3f);
+        int i = (int)u;
+        float t = u - i;
+        const float* p = &data[i];
+        float a = p[3] - 3.f * p[2] + 3.f * p[1] - p[0];
+        float b = 2.f * p[0] - 5.f * p[1] + 4.f * p[2] - p[3];
+        float c = p[2] - p[0];
+        return p[1] + 0.5f * t * (c + t * (b + t * a));
+    }
+
+    // Index and fraction are computed on all four lanes at once; only the
+    // four neighbour loads go lane by lane.
+    float_4 eval(float_4 x) const {
+        float_4 u = simd::clamp((x - x0) * invStep, 0.f, N - 1e-3f);
+        int32_4 i = int32_4(u);
+        float_4 t = u - float_4(i);
+        float_4 p0, p1, p2, p3;
+        for (int k = 0; k < 4; k++) {
+            const float* p = &data[i[k]];
+            p0[k] = p[0];
+            p1[k] = p[1];
+            p2[k] = p[2];
+            p3[k] = p[3];
+        }
+        float_4 a = p3 - 3.f * p2 + 3.f * p1 - p0;
+        float_4 b = 2.f * p0 - 5.f * p1 + 4.f * p2 - p3;
+        float_4 c = p2 - p0;
+        return p1 + 0.5f * t * (c + t * (b + t * a));
+    }
+};
+
+
+// Shared, read-only tables for the fold curves, built once on first use.
+// Everything the fold needs per sample -- the logistic, its antiderivative and
+// the |x|^n power -- becomes a table read, so no exp/log/pow runs in process().
+// The sine terms stay on polySin/polyCos, which are already plain polynomials.
+struct TatamiFoldTables {
+    static constexpr float LOGISTIC_RANGE = 12.f; // tanh(12) and log(1+exp(-24)) are flat to float precision
+
+    TatamiCubicTable<1024> tanhTable;        // scaledLogistic(a) = tanh(a), a >= 0
+    TatamiCubicTable<1024> softplusTail;     // log(1+exp(-2a)), a >= 0
+    TatamiCubicTable<256> log2Mantissa;      // log2(m), m in [1, 2)
+    TatamiCubicTable<256> exp2Fraction;      // 2^f, f in [0, 1)
+
+    TatamiFoldTables() {
+        tanhTable.build([](float a) { return std::tanh(a); }, 0.f, LOGISTIC_RANGE);
+        softplusTail.build([](float a) { return std::log1p(std::exp(-2.f * a)); }, 0.f, LOGISTIC_RANGE);
+        log2Mantissa.build([](float m) { return std::log2(m); }, 1.f, 2.f);
+        exp2Fraction.build([](float f) { return std::exp2(f); }, 0.f, 1.f);
+    }
+
+    static const TatamiFoldTables& get() {
+        static const TatamiFoldTables tables;
+        return tables;
+    }
+
+    // 2/(1+exp(-2x)) - 1
+    float logistic(float x) const {
+        float y = tanhTable.eval(std::fabs(x));
+        return x < 0.f ? -y : y;
+    }
+
+    // log(1+exp(2x)) - x = |x| + log(1+exp(-2|x|))
+    float logisticAntiderivative(float x) const {
+        float a = std::fabs(x);
+        return a + softplusTail.eval(a);
+    }
+
+    // sgn(x)*|x|^n through exp2(n*log2|x|), split into exponent bits and table lookups
+    float signedPower(float x, float n) const {
+        float a = std::fabs(x);
+        if (a < 1e-20f) return 0.f;
+        uint32_t bits;
+        std::memcpy(&bits, &a, sizeof(bits));
+        int exponent = (int)((bits >> 23) & 0xFF) - 127;
+        uint32_t mantissaBits = (bits & 0x007FFFFF) | 0x3F800000;
+        float mantissa;
+        std::memcpy(&mantissa, &mantissaBits, sizeof(mantissa));
+
+        float y = clamp(n * (exponent + log2Mantissa.eval(mantissa)), -126.f, 127.f);
+        float whole = std::floor(y);
+        uint32_t scaleBits = (uint32_t)((int)whole + 127) << 23;
+        float scale;
+        std::memcpy(&scale, &scaleBits, sizeof(scale));
+
+        float mag = exp2Fraction.eval(y - whole) * scale;
+        return x < 0.f ? -mag : mag;
+    }
+
+    float_4 logistic(float_4 x) const {
+        float_4 y = tanhTable.eval(simd::fabs(x));
+        return simd::ifelse(x < 0.f, -y, y);
+    }
+
+    float_4 logisticAntiderivative(float_4 x) const {
+        float_4 a = simd::fabs(x);
+        return a + softplusTail.eval(a);
+    }
+
+    // Same bit split as the scalar version, done on all four lanes
+    float_4 signedPower(float_4 x, float_4 n) const {
+        float_4 a = simd::fabs(x);
+        int32_4 bits = int32_4::cast(a);
+        float_4 exponent = float_4((bits >> 23) & int32_4(0xFF)) - 127.f;
+        float_4 mantissa = float_4::cast((bits & int32_4(0x007FFFFF)) | int32_4(0x3F800000));
+
+        float_4 y = simd::clamp(n * (exponent + log2Mantissa.eval(mantissa)), -126.f, 127.f);
+        float_4 whole = simd::floor(y);
+        float_4 scale = float_4::cast((int32_4(whole) + int32_4(127)) << 23);
+
+        float_4 mag = exp2Fraction.eval(y - whole) * scale;
+        mag = simd::ifelse(x < 0.f, -mag, mag);
+        return simd::ifelse(a < 1e-20f, 0.f, mag);
+    }
+};
+
+
+template <typename T = float>
 struct SecondOrderHPF {
-    float x1 = 0, x2 = 0; // previous two inputs
-    float y1 = 0, y2 = 0; // previous two outputs
+    T x1 = 0, x2 = 0;     // previous two inputs
+    T y1 = 0, y2 = 0;     // previous two outputs
     float a0, a1, a2;     // filter coefficients for the input
     float b1, b2;         // filter coefficients for the output
 
@@ -100,8 +296,8 @@ struct SecondOrderHPF {
     }
 
     // Process the input sample
-    float process(float input) {
-        float output = a0 * input + a1 * x1 + a2 * x2 - b1 * y1 - b2 * y2;
+    T process(T input) {
+        T output = a0 * input + a1 * x1 + a2 * x2 - b1 * y1 - b2 * y2;
         x2 = x1;
         x1 = input;
         y2 = y1;
@@ -183,19 +379,24 @@ struct Tatami : Module {
     float alpha = 0.01f;
     float inputL[16] = {0.0f};
     float inputR[16] = {0.0f};
-    float envPeakL[16] = {0.0f};
-    float envPeakR[16] = {0.0f};
-    float filteredEnvelopeL[16] = {0.0f};
-    float filteredEnvelopeR[16] = {0.0f};
-    float lastOutputL = 0.0f;
-    float lastOutputR = 0.0f;
     float outputL[16] = {0.0f};
     float outputR[16] = {0.0f};
     bool initialize = true;
     bool applyFilters = true;
-    
+
+    // Shared fold curve tables
+    const TatamiFoldTables& foldTables = TatamiFoldTables::get();
+
+    // Per-channel state, four channels per float_4
+    float_4 envPeakL[4] = {};
+    float_4 envPeakR[4] = {};
+    float_4 filteredEnvelopeL[4] = {};
+    float_4 filteredEnvelopeR[4] = {};
+    float_4 lastFoldInputL[4] = {}; // previous fold input, for the ADAA difference
+    float_4 lastFoldInputR[4] = {};
+
     // Declare high-pass filter
-    SecondOrderHPF hpfL[16], hpfR[16];
+    SecondOrderHPF<float_4> hpfL[4], hpfR[4];
 
     //For the display
     CircularBuffer<float, 1024> waveBuffers[3];
@@ -277,7 +478,7 @@ struct Tatami : Module {
 
         // Setup filters
         if (initialize){
-            for (int i=0; i<16; i++){
+            for (int i=0; i<4; i++){
                 hpfL[i].setCutoffFrequency(sampleRate, 10.0f); // Set cutoff frequency
                 hpfR[i].setCutoffFrequency(sampleRate, 10.0f);
             }
@@ -292,167 +493,142 @@ struct Tatami : Module {
         outputs[AUDIO_L_OUTPUT].setChannels(numChannels);
         outputs[AUDIO_R_OUTPUT].setChannels(numChannels);
 
-        // Check if each input is monophonic
-        bool isShapeMonophonic = inputs[SHAPE_INPUT].isConnected() && (inputs[SHAPE_INPUT].getChannels() == 1);
-        bool isCompressMonophonic = inputs[COMPRESS_INPUT].isConnected() && (inputs[COMPRESS_INPUT].getChannels() == 1);
-        bool isSymmetryMonophonic = inputs[SYMMETRY_INPUT].isConnected() && (inputs[SYMMETRY_INPUT].getChannels() == 1);
-        bool isDensity1Monophonic = inputs[DENSITY_INPUT1].isConnected() && (inputs[DENSITY_INPUT1].getChannels() == 1);
-        bool isDensity2Monophonic = inputs[DENSITY_INPUT2].isConnected() && (inputs[DENSITY_INPUT2].getChannels() == 1);
-
-        // Get monophonic input values
-        float shapeMonoValue = isShapeMonophonic ? inputs[SHAPE_INPUT].getVoltage(0) : 0.0f;
-        float compressMonoValue = isCompressMonophonic ? inputs[COMPRESS_INPUT].getVoltage(0) : 0.0f;
-        float symmetryMonoValue = isSymmetryMonophonic ? inputs[SYMMETRY_INPUT].getVoltage(0) : 0.0f;
-        float densityMonoValue1 = isDensity1Monophonic ? inputs[DENSITY_INPUT1].getVoltage(0) : 0.0f;
-        float densityMonoValue2 = isDensity2Monophonic ? inputs[DENSITY_INPUT2].getVoltage(0) : 0.0f;
-
-        if (inputs[DENSITY_INPUT1].isConnected() && !inputs[DENSITY_INPUT2].isConnected()) {
-            // Normalize Density Input 2 to Density Input 1
-            densityMonoValue2 = densityMonoValue1;
-        } else if (!inputs[DENSITY_INPUT1].isConnected() && inputs[DENSITY_INPUT2].isConnected()) {
-            // Normalize Density Input 1 to Density Input 2
-            densityMonoValue1 = densityMonoValue2;
-        }
+        bool audioLConnected = inputs[AUDIO_L_INPUT].isConnected();
+        bool audioRConnected = inputs[AUDIO_R_INPUT].isConnected();
+        bool density1Connected = inputs[DENSITY_INPUT1].isConnected();
+        bool density2Connected = inputs[DENSITY_INPUT2].isConnected();
+
+        // Map a lone audio input to both sides, and a lone density CV to both densities
+        int audioLSource = audioLConnected ? AUDIO_L_INPUT : AUDIO_R_INPUT;
+        int audioRSource = audioRConnected ? AUDIO_R_INPUT : AUDIO_L_INPUT;
+        int density1Source = density1Connected ? DENSITY_INPUT1 : DENSITY_INPUT2;
+        int density2Source = density2Connected ? DENSITY_INPUT2 : DENSITY_INPUT1;
+
+        float shapeParam = params[SHAPE_PARAM].getValue();
+        float shapeAtt = params[SHAPE_ATT_PARAM].getValue();
+        float compressParam = params[COMPRESS_PARAM].getValue()*0.1f;
+        float compressAtt = params[COMPRESS_ATT_PARAM].getValue()*0.1f;
+        float symmetryParam = params[SYMMETRY_PARAM].getValue();
+        float symmetryAtt = params[SYMMETRY_ATT_PARAM].getValue();
+        float densityParamL = params[DENSITY_PARAM1].getValue();
+        float densityParamR = params[DENSITY_PARAM2].getValue();
+        float densityAtt = params[DENSITY_ATT_PARAM].getValue();
 
         float shape_top = 0.0f;
         float zero_tracking = 0.0f;
 
-        for (int c = 0; c < numChannels; c++) {
-            // Process Shape input
-            float shape = params[SHAPE_PARAM].getValue();
-            if (inputs[SHAPE_INPUT].isConnected()) {
-                shape += (isShapeMonophonic ? shapeMonoValue : inputs[SHAPE_INPUT].getVoltage(c)) * params[SHAPE_ATT_PARAM].getValue();
-            }
+        TatamiFoldBlend blend;
+
+        for (int c = 0; c < numChannels; c += 4) {
+            int b = c / 4;
+
+            // Process Shape input (mono CVs are broadcast to every channel)
+            float_4 shape = shapeParam + inputs[SHAPE_INPUT].getPolyVoltageSimd<float_4>(c) * shapeAtt;
 
             // Wrap the shape value to the range [0, 3)
-            shape = fmod(shape, 3.0f);
-            if (shape < 0.0f) {
-                shape += 3.0f; // Wrapping from negative to positive
-            }
-            shape = clamp (shape, 0.0f, 3.0f);
-            if (c==0){shape_top = shape;}
+            shape -= 3.0f * simd::floor(shape * (1.0f / 3.0f));
+            shape = simd::clamp(shape, 0.0f, 3.0f);
+            if (c==0){shape_top = shape[0];}
 
             // Process Compress input
-            float compress = params[COMPRESS_PARAM].getValue()*0.1f;
-            if (inputs[COMPRESS_INPUT].isConnected()) {
-                compress += (isCompressMonophonic ? compressMonoValue : inputs[COMPRESS_INPUT].getVoltage(c)) * 0.1f * params[COMPRESS_ATT_PARAM].getValue();
-            }
-            compress = clamp(compress, 0.0f, 1.0f);
+            float_4 compress = compressParam + inputs[COMPRESS_INPUT].getPolyVoltageSimd<float_4>(c) * compressAtt;
+            compress = simd::clamp(compress, 0.0f, 1.0f);
 
             // Process Symmetry input
-            float symmetry = params[SYMMETRY_PARAM].getValue();
-            if (inputs[SYMMETRY_INPUT].isConnected()) {
-                symmetry += (isSymmetryMonophonic ? symmetryMonoValue : inputs[SYMMETRY_INPUT].getVoltage(c)) * params[SYMMETRY_ATT_PARAM].getValue();
-            }
-            symmetry = clamp(symmetry, -5.0f, 5.0f);
+            float_4 symmetry = symmetryParam + inputs[SYMMETRY_INPUT].getPolyVoltageSimd<float_4>(c) * symmetryAtt;
+            symmetry = simd::clamp(symmetry, -5.0f, 5.0f);
 
             // Process Density inputs (normalized if one is disconnected)
-            float densityLeft = params[DENSITY_PARAM1].getValue();
-            float densityRight = params[DENSITY_PARAM2].getValue();
-
-            if (inputs[DENSITY_INPUT1].isConnected() || inputs[DENSITY_INPUT2].isConnected()) {
-                float densityInput1 = (isDensity1Monophonic ? densityMonoValue1 : inputs[DENSITY_INPUT1].getVoltage(c));
-                float densityInput2 = (isDensity2Monophonic ? densityMonoValue2 : inputs[DENSITY_INPUT2].getVoltage(c));
-
-                if (inputs[DENSITY_INPUT1].isConnected() && !inputs[DENSITY_INPUT2].isConnected()) {
-                    densityInput2 = densityInput1; // Normalize Input 2 to Input 1
-                } else if (!inputs[DENSITY_INPUT1].isConnected() && inputs[DENSITY_INPUT2].isConnected()) {
-                    densityInput1 = densityInput2; // Normalize Input 1 to Input 2
-                }
-
-                densityLeft += densityInput1 * params[DENSITY_ATT_PARAM].getValue();
-                densityRight += densityInput2 * params[DENSITY_ATT_PARAM].getValue();
-            }
-            densityLeft = clamp (densityLeft, 1.0f, 30.0f);
-            densityRight = clamp (densityRight, 1.0f, 30.0f);
-            
-            if (inputs[AUDIO_L_INPUT].isConnected() && inputs[AUDIO_R_INPUT].isConnected()) {
-                // Both L and R are connected, use them directly
-                inputL[c] = inputs[AUDIO_L_INPUT].getVoltage(c);
-                inputR[c] = inputs[AUDIO_R_INPUT].getVoltage(c);
-            }
-            else if (inputs[AUDIO_L_INPUT].isConnected() && !inputs[AUDIO_R_INPUT].isConnected()) {
-                // Only L is connected, map L to both L and R
-                inputL[c] = inputs[AUDIO_L_INPUT].getVoltage(c);
-                inputR[c] = inputs[AUDIO_L_INPUT].getVoltage(c);
+            float_4 densityLeft = densityParamL;
+            float_4 densityRight = densityParamR;
+            if (density1Connected || density2Connected) {
+                densityLeft += inputs[density1Source].getPolyVoltageSimd<float_4>(c) * densityAtt;
+                densityRight += inputs[density2Source].getPolyVoltageSimd<float_4>(c) * densityAtt;
             }
-            else if (!inputs[AUDIO_L_INPUT].isConnected() && inputs[AUDIO_R_INPUT].isConnected()) {
-                // Only R is connected, map R to both L and R
-                inputL[c] = inputs[AUDIO_R_INPUT].getVoltage(c);
-                inputR[c] = inputs[AUDIO_R_INPUT].getVoltage(c);
+            densityLeft = simd::clamp(densityLeft, 1.0f, 30.0f);
+            densityRight = simd::clamp(densityRight, 1.0f, 30.0f);
+
+            float_4 inL = 0.0f;
+            float_4 inR = 0.0f;
+            if (audioLConnected || audioRConnected) {
+                inL = inputs[audioLSource].getVoltageSimd<float_4>(c);
+                inR = inputs[audioRSource].getVoltageSimd<float_4>(c);
             }
-            else {
-                // Neither L nor R is connected, default to 0V for both
-                inputL[c] = 0.0f;
-                inputR[c] = 0.0f;
-            }
-            
-            inputL[c] = clamp (inputL[c], -10.f, 10.f);
-            inputR[c] = clamp (inputR[c], -10.f, 10.f);
-            
-            if (c==0){zero_tracking = inputL[0];} //for centering the scope signal
+            inL = simd::clamp(inL, -10.f, 10.f);
+            inR = simd::clamp(inR, -10.f, 10.f);
 
-            if (compress > 0.01f){ //check if compression is enabled
-                // Simple peak detection using the absolute maximum of the current input
-                envPeakL[c] = fmax(envPeakL[c] * decayRate, fabs(inputL[c]));
-                envPeakR[c] = fmax(envPeakR[c] * decayRate, fabs(inputR[c]));
+            if (c==0){zero_tracking = inL[0];} //for centering the scope signal
 
-                filteredEnvelopeL[c] = fmax(filteredEnvelopeL[c],0.1f);
-                filteredEnvelopeR[c] = fmax(filteredEnvelopeR[c],0.1f);
+            // Compression runs only in the lanes where it is enabled
+            float_4 compressOn = compress > 0.01f;
+            if (simd::movemask(compressOn)) {
+                // Simple peak detection using the absolute maximum of the current input
+                float_4 peakL = simd::fmax(envPeakL[b] * decayRate, simd::fabs(inL));
+                float_4 peakR = simd::fmax(envPeakR[b] * decayRate, simd::fabs(inR));
+                envPeakL[b] = simd::ifelse(compressOn, peakL, envPeakL[b]);
+                envPeakR[b] = simd::ifelse(compressOn, peakR, envPeakR[b]);
 
-                filteredEnvelopeL[c] = alpha * envPeakL[c] + (1 - alpha) * filteredEnvelopeL[c];
-                filteredEnvelopeR[c] = alpha * envPeakR[c] + (1 - alpha) * filteredEnvelopeR[c];
+                float_4 envL = alpha * envPeakL[b] + (1 - alpha) * simd::fmax(filteredEnvelopeL[b], 0.1f);
+                float_4 envR = alpha * envPeakR[b] + (1 - alpha) * simd::fmax(filteredEnvelopeR[b], 0.1f);
+                filteredEnvelopeL[b] = simd::ifelse(compressOn, envL, filteredEnvelopeL[b]);
+                filteredEnvelopeR[b] = simd::ifelse(compressOn, envR, filteredEnvelopeR[b]);
 
                 // Compress audio inputs:
-                inputL[c] = (inputL[c]/filteredEnvelopeL[c])*compress*5.0f + inputL[c]*(1-compress);
-                inputR[c] = (inputR[c]/filteredEnvelopeR[c])*compress*5.0f + inputR[c]*(1-compress);
+                inL = simd::ifelse(compressOn, (inL/filteredEnvelopeL[b])*compress*5.0f + inL*(1-compress), inL);
+                inR = simd::ifelse(compressOn, (inR/filteredEnvelopeR[b])*compress*5.0f + inR*(1-compress), inR);
             }
 
             // Apply Symmetry
-            inputL[c] += symmetry;
-            inputR[c] += symmetry;
+            inL += symmetry;
+            inR += symmetry;
 
             // Apply Density
-            inputL[c] *= densityLeft;
-            inputR[c] *= densityRight;
+            inL *= densityLeft;
+            inR *= densityRight;
 
-            inputL[c] = clamp (inputL[c], -200.f, 200.f);
-            inputR[c] = clamp (inputR[c], -200.f, 200.f);
+            inL = simd::clamp(inL, -200.f, 200.f);
+            inR = simd::clamp(inR, -200.f, 200.f);
+            inL.store(&inputL[c]);
+            inR.store(&inputR[c]);
 
-            // Apply ADAA wavefolding
-            outputL[c] = applyADAAWaveFolding(inputL[c]*0.2f, lastOutputL, sampleRate, shape);
-            outputR[c] = applyADAAWaveFolding(inputR[c]*0.2f, lastOutputR, sampleRate, shape);
+            // Apply ADAA wavefolding, each channel against its own previous input
+            blend.setShape(shape);
+            float_4 foldInL = inL*0.2f;
+            float_4 foldInR = inR*0.2f;
+            float_4 outL = applyADAAWaveFolding(foldInL, lastFoldInputL[b], blend);
+            float_4 outR = applyADAAWaveFolding(foldInR, lastFoldInputR[b], blend);
+            lastFoldInputL[b] = foldInL;
+            lastFoldInputR[b] = foldInR;
 
-            lastOutputL = outputL[c];
-            lastOutputR = outputR[c];
+            outL *= 5.0f;
+            outR *= 5.0f;
 
-            outputL[c] *= 5.0f;
-            outputR[c] *= 5.0f;
+            outL -= symmetry;
+            outR -= symmetry;
 
-            outputL[c] -= symmetry;
-            outputR[c] -= symmetry;
-
-            // Undo compression after wavefolding:
-            if (compress > 0.01f){ //double check for div zero
-                outputL[c] = (outputL[c] - outputL[c] * (1 - compress)) / (compress * 5.0f / filteredEnvelopeL[c]);
-                outputR[c] = (outputR[c] - outputR[c] * (1 - compress)) / (compress * 5.0f / filteredEnvelopeR[c]);
-            }
+            // Undo compression after wavefolding: (out - out*(1-c)) / (c*5/env) reduces to out*env/5
+            outL = simd::ifelse(compressOn, outL * filteredEnvelopeL[b] * 0.2f, outL);
+            outR = simd::ifelse(compressOn, outR * filteredEnvelopeR[b] * 0.2f, outR);
 
             if (applyFilters){
-                outputL[c] = hpfL[c].process(outputL[c]);
-                outputR[c] = hpfR[c].process(outputR[c]);
+                outL = hpfL[b].process(outL);
+                outR = hpfR[b].process(outR);
             }
 
             if (isSupersamplingEnabled) {
-                outputL[c] = shaperL[c].process(outputL[c]);
-                outputR[c] = shaperR[c].process(outputR[c]);
+                for (int i = 0; i < 4 && c + i < numChannels; i++) {
+                    outL[i] = shaperL[c + i].process(outL[i]);
+                    outR[i] = shaperR[c + i].process(outR[i]);
+                }
             }
 
-            outputL[c] = clamp(outputL[c], -10.0f, 10.0f);
-            outputR[c] = clamp(outputR[c], -10.0f, 10.0f);
+            outL = simd::clamp(outL, -10.0f, 10.0f);
+            outR = simd::clamp(outR, -10.0f, 10.0f);
+            outL.store(&outputL[c]);
+            outR.store(&outputR[c]);
 
-            outputs[AUDIO_L_OUTPUT].setVoltage(outputL[c], c);
-            outputs[AUDIO_R_OUTPUT].setVoltage(outputR[c], c);
+            outputs[AUDIO_L_OUTPUT].setVoltageSimd(outL, c);
+            outputs[AUDIO_R_OUTPUT].setVoltageSimd(outR, c);
 
         }//end channels
 
@@ -495,26 +671,26 @@ struct Tatami : Module {
         float functionX = funcPhase*20.0f - 10.0f;
         if (shape_top == 0.0f) {
             // If shape is 0, return logistic function
-            functionVal = scaledLogistic(functionX);
+            functionVal = foldTables.logistic(functionX);
         }
         else if (shape_top <= 1.0f) {
             // Morph between logistic and sin(x)
-            functionVal =  (scaledLogistic(functionX) * (1.f-shape_top)) + polySin(functionX)*shape_top;
+            functionVal =  (foldTables.logistic(functionX) * (1.f-shape_top)) + polySin(functionX)*shape_top;
         }
         else if (shape_top <= 2.0f) {
             // Morph between sin(x) and sin(x^n)
             float powerVal = 0.5f * (shape_top - 1.0f) + 1.0f;
-            float powerInput = sgn(functionX)*pow(fabs(functionX), powerVal);
+            float powerInput = foldTables.signedPower(functionX, powerVal);
             float morphShape = shape_top-1.f;
 
             functionVal =  (polySin(functionX) * (1.f-morphShape)) + (polySin(powerInput) * morphShape);
         }
         else {
             // Morph between sin(x^2) and logistic
-            float powerInput = sgn(functionX)*pow(fabs(functionX), 1.5f);
+            float powerInput = foldTables.signedPower(functionX, 1.5f);
             float morphShape = shape_top-2.f;
 
-            functionVal =  (polySin(powerInput) * (1.f-morphShape)) + (scaledLogistic(functionX) * morphShape);
+            functionVal =  (polySin(powerInput) * (1.f-morphShape)) + (foldTables.logistic(functionX) * morphShape);
         }
         int funcsampleIndex = static_cast<int>(funcPhase * 1024);
         if (funcsampleIndex < 0) funcsampleIndex = 0;
@@ -523,72 +699,45 @@ struct Tatami : Module {
 
     }
 
-    float applyADAAWaveFolding(float input, float lastInput, float sampleRate, float shape) {
-        float delta = input - lastInput;
+    // First-order ADAA over the blended fold. All three curves are evaluated
+    // per lane and weighted, so the shape regions need no branches.
+    float_4 applyADAAWaveFolding(float_4 input, float_4 lastInput, const TatamiFoldBlend& blend) {
+        float_4 delta = input - lastInput;
+        float_4 useADAA = simd::fabs(delta) > 1e-6f;
 
-        if (fabs(delta) > 1e-6) {
-            if (shape == 0.0f) {
-                // Logistic function
-                return (logisticAntiderivative(input) - logisticAntiderivative(lastInput)) / delta;
-            }
-            else if (shape <= 1.0f) {
-                // Morph between logistic and sin(x) for 0 < shape <= 1
-                return ( (logisticAntiderivative(input)*(1.f-shape) - polyCos(input)*shape) -
-                         (logisticAntiderivative(lastInput)*(1.f-shape) - polyCos(lastInput)*shape) ) / delta;
-            }
-            else if (shape <= 2.0f) {
-                // Morph between sin(x) and sin(x^n) for 1 < shape <= 2
-                float powerVal = 0.5f * (shape - 1.0f) + 1.0f;
-                float powerInput = sgn(input)*pow(fabs(input), powerVal);
-                float powerLastInput = sgn(lastInput)*pow(fabs(lastInput), powerVal);
-                float morphShape = shape-1.f;
-
-                return (  (-polyCos(input) * (1.f-morphShape)  - polyCos(powerInput) * morphShape ) -
-                          (-polyCos(lastInput) * (1.f-morphShape) - polyCos(powerLastInput) * morphShape ) ) / delta;
-            }
-            else {
-                // Morph between sin(x^n) and logistic for 2 < shape <= 3
-                float powerInput = sgn(input)*pow(fabs(input), 1.5f);
-                float powerLastInput = sgn(lastInput)*pow(fabs(lastInput), 1.5f);
-                float morphShape = shape-2.f;
-
-                return ( (-polyCos(powerInput) * (1.f-morphShape) + logisticAntiderivative(input) * morphShape) -
-                         (-polyCos(powerLastInput) * (1.f-morphShape) + logisticAntiderivative(lastInput) * morphShape) ) / delta;
-            }
+        float_4 adaa = 0.0f;
+        if (simd::movemask(useADAA)) {
+            float_4 safeDelta = simd::ifelse(useADAA, delta, 1.0f);
+            adaa = (foldAntiderivative(input, blend) - foldAntiderivative(lastInput, blend)) / safeDelta;
         }
-        else {
-            if (shape == 0.0f) {
-                // If shape is 0, return logistic function
-                return scaledLogistic(input);
-            }
-            else if (shape <= 1.0f) {
-                // Morph between logistic and sin(x)
-                return (scaledLogistic(input) * (1.f-shape)) + polySin(input)*shape;
-            }
-            else if (shape <= 2.0f) {
-                // Morph between sin(x) and sin(x^n)
-                float powerVal = 0.5f * (shape - 1.0f) + 1.0f;
-                float powerInput = sgn(input)*pow(fabs(input), powerVal);
-                float morphShape = shape-1.f;
-
-                return (polySin(input) * (1.f-morphShape)) + (polySin(powerInput) * morphShape);
-            }
-            else {
-                // Morph between sin(x^2) and logistic
-                float powerInput = sgn(input)*pow(fabs(input), 1.5f);
-                float morphShape = shape-2.f;
-
-                return (polySin(powerInput) * (1.f-morphShape)) + (scaledLogistic(input) * morphShape);
-            }
+        if (simd::movemask(useADAA) == 0xF) {
+            return adaa;
         }
+        // Fall back to the direct curve where the input barely moved
+        return simd::ifelse(useADAA, adaa, foldFunction(input, blend));
     }
 
-    float scaledLogistic(float x, float k = 2.0f) {
-        return 2.0f / (1.0f + exp(-k * x)) - 1.0f;
+    // Antiderivative of the fold: -cos stands in for the sine terms, as before
+    float_4 foldAntiderivative(float_4 x, const TatamiFoldBlend& blend) {
+        float_4 result = -blend.wSin * polyCos(x);
+        if (blend.anyLogistic) {
+            result += blend.wLogistic * foldTables.logisticAntiderivative(x);
+        }
+        if (blend.anyPowSin) {
+            result -= blend.wPowSin * polyCos(foldTables.signedPower(x, blend.power));
+        }
+        return result;
     }
 
-    float logisticAntiderivative(float x, float k = 2.0f) {
-        return (2.0f / k) * log(1.0f + exp(k * x)) - x;
+    float_4 foldFunction(float_4 x, const TatamiFoldBlend& blend) {
+        float_4 result = blend.wSin * polySin(x);
+        if (blend.anyLogistic) {
+            result += blend.wLogistic * foldTables.logistic(x);
+        }
+        if (blend.anyPowSin) {
+            result += blend.wPowSin * polySin(foldTables.signedPower(x, blend.power));
+        }
+        return result;
     }
 
 };
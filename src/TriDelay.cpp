@@ -11,7 +11,9 @@
 
 #include "rack.hpp"
 #include "plugin.hpp"
+#include <atomic>
 using namespace rack;
+using simd::float_4;
 
 template<typename T, size_t Size>
 class CircularBuffer {
@@ -76,6 +78,196 @@ private:
     }
 };
 
+// Stereo delay ring with a selectable sample format. The ring length is a power
+// of two so positions wrap with a mask.
+//   FLOAT32      4 bytes/sample
+//   INT16_BLOCK  2 bytes/sample plus one scale per 64-sample block
+//   FLOAT16      2 bytes/sample, IEEE half precision
+// Block scales follow the signal level, so quiet passages keep their
+// resolution. Each block's scale is chosen as the write head enters it. If a
+// louder sample arrives mid-block, the scale grows and the block's earlier
+// samples are requantized.
+struct TriDelayMemory {
+    enum Format { FLOAT32, INT16_BLOCK, FLOAT16, NUM_FORMATS };
+
+    static constexpr int BLOCK_SHIFT = 6;
+    static constexpr int BLOCK_SIZE = 1 << BLOCK_SHIFT;
+    static constexpr float MAX_LEVEL = 10.f;            // Writes are clamped to +-10V
+    static constexpr float MIN_LEVEL = 1.f / 1024.f;    // Smallest block full-scale
+
+    Format format;
+    bool longMemory;    // Sized for the 60 s range rather than the switch ranges
+    uint32_t capacity;
+    uint32_t mask;
+
+    std::vector<float> f32[2];
+    std::vector<int16_t> i16[2];        // INT16_BLOCK and FLOAT16 payloads
+    std::vector<float> blockStep[2];    // INT16_BLOCK quantization step per block
+    uint32_t writeBlock[2] = {~0u, ~0u};
+    float blockPeak[2] = {0.f, 0.f};
+
+    TriDelayMemory(Format format, bool longMemory, uint32_t minSamples) : format(format), longMemory(longMemory) {
+        capacity = 1;
+        while (capacity < minSamples) capacity <<= 1;
+        capacity = std::max<uint32_t>(capacity, BLOCK_SIZE);
+        mask = capacity - 1;
+        for (int side = 0; side < 2; side++) {
+            if (format == FLOAT32) {
+                f32[side].assign(capacity, 0.f);
+            } else {
+                i16[side].assign(capacity, 0);
+            }
+            if (format == INT16_BLOCK) {
+                blockStep[side].assign(capacity >> BLOCK_SHIFT, MAX_LEVEL / 32767.f);
+            }
+        }
+    }
+
+    static size_t bytesPerSample(Format format) {
+        return (format == FLOAT32) ? 4 : 2;
+    }
+
+    float read(int side, uint32_t index) const {
+        index &= mask;
+        switch (format) {
+            case INT16_BLOCK: return i16[side][index] * blockStep[side][index >> BLOCK_SHIFT];
+            case FLOAT16: return halfToFloat(i16[side][index]);
+            default: return f32[side][index];
+        }
+    }
+
+    void write(int side, uint32_t index, float value) {
+        index &= mask;
+        switch (format) {
+            case INT16_BLOCK: writeBlockScaled(side, index, value); break;
+            case FLOAT16: i16[side][index] = static_cast<int16_t>(floatToHalf(value)); break;
+            default: f32[side][index] = value; break;
+        }
+    }
+
+    // Silence is exact in every format and needs no scale bookkeeping
+    void clear(uint32_t index) {
+        index &= mask;
+        for (int side = 0; side < 2; side++) {
+            if (format == FLOAT32) f32[side][index] = 0.f;
+            else i16[side][index] = 0;
+        }
+    }
+
+    // Gather four consecutive samples from each of four read positions, point k
+    // of position t landing in y[k][t]. The format is resolved once per call.
+    void gather(const uint32_t* readIndex, float_4* yL, float_4* yR) const {
+        if (format == FLOAT32) {
+            for (int t = 0; t < 4; t++) {
+                for (int k = 0; k < 4; k++) {
+                    uint32_t index = (readIndex[t] + k) & mask;
+                    yL[k][t] = f32[0][index];
+                    yR[k][t] = f32[1][index];
+                }
+            }
+        } else if (format == INT16_BLOCK) {
+            // Gather raw integers, then scale all four positions at once
+            float_4 stepL[4], stepR[4];
+            for (int t = 0; t < 4; t++) {
+                for (int k = 0; k < 4; k++) {
+                    uint32_t index = (readIndex[t] + k) & mask;
+                    yL[k][t] = i16[0][index];
+                    yR[k][t] = i16[1][index];
+                    stepL[k][t] = blockStep[0][index >> BLOCK_SHIFT];
+                    stepR[k][t] = blockStep[1][index >> BLOCK_SHIFT];
+                }
+            }
+            for (int k = 0; k < 4; k++) {
+                yL[k] *= stepL[k];
+                yR[k] *= stepR[k];
+            }
+        } else {
+            for (int t = 0; t < 4; t++) {
+                for (int k = 0; k < 4; k++) {
+                    uint32_t index = (readIndex[t] + k) & mask;
+                    yL[k][t] = halfToFloat(i16[0][index]);
+                    yR[k][t] = halfToFloat(i16[1][index]);
+                }
+            }
+        }
+    }
+
+    void writeBlockScaled(int side, uint32_t index, float value) {
+        uint32_t block = index >> BLOCK_SHIFT;
+        float* step = &blockStep[side][block];
+        float level = std::fabs(value);
+
+        if (block != writeBlock[side]) {
+            // Entering a new block: size it from the last block's peak with 2x headroom
+            *step = clamp(2.f * blockPeak[side], MIN_LEVEL, MAX_LEVEL) / 32767.f;
+            writeBlock[side] = block;
+            blockPeak[side] = 0.f;
+        }
+        blockPeak[side] = std::max(blockPeak[side], level);
+
+        if (level > *step * 32767.f) {
+            // Louder than the block's range: widen it and requantize what this block already holds
+            float newStep = clamp(2.f * level, MIN_LEVEL, MAX_LEVEL) / 32767.f;
+            float ratio = *step / newStep;
+            int16_t* data = &i16[side][block << BLOCK_SHIFT];
+            for (uint32_t i = 0; i < (index & (BLOCK_SIZE - 1)); i++) {
+                data[i] = static_cast<int16_t>(std::lround(data[i] * ratio));
+            }
+            *step = newStep;
+        }
+        i16[side][index] = static_cast<int16_t>(clamp((float)std::lround(value / *step), -32767.f, 32767.f));
+    }
+
+    // IEEE half conversions by bit manipulation, with round-to-nearest-even
+    static uint16_t floatToHalf(float f) {
+        uint32_t x;
+        std::memcpy(&x, &f, 4);
+        uint32_t sign = x & 0x80000000u;
+        x ^= sign;
+        uint32_t h;
+        if (x >= 0x47800000u) {
+            h = (x > 0x7F800000u) ? 0x7E00u : 0x7C00u;  // NaN or overflow to Inf
+        } else if (x < 0x38800000u) {
+            // Subnormal half: let the FPU round by adding 0.5f, which lines the mantissa up
+            float denormMagic = 0.5f, fx;
+            std::memcpy(&fx, &x, 4);
+            fx += denormMagic;
+            uint32_t fxBits, magicBits;
+            std::memcpy(&fxBits, &fx, 4);
+            std::memcpy(&magicBits, &denormMagic, 4);
+            h = fxBits - magicBits;
+        } else {
+            uint32_t mantissaOdd = (x >> 13) & 1;
+            x += (uint32_t)(15 - 127) << 23;
+            x += 0xFFF + mantissaOdd;
+            h = x >> 13;
+        }
+        return static_cast<uint16_t>(h | (sign >> 16));
+    }
+
+    static float halfToFloat(uint16_t h) {
+        const uint32_t shiftedExp = 0x7C00u << 13;
+        uint32_t o = (h & 0x7FFFu) << 13;
+        uint32_t exp = o & shiftedExp;
+        o += (uint32_t)(127 - 15) << 23;
+        float f;
+        if (exp == shiftedExp) {
+            o += (uint32_t)(128 - 16) << 23;        // Inf/NaN
+            std::memcpy(&f, &o, 4);
+        } else if (exp == 0) {
+            o += 1u << 23;                          // Subnormal: renormalize
+            std::memcpy(&f, &o, 4);
+            f -= 6.10351562e-05f;                   // 2^-14
+        } else {
+            std::memcpy(&f, &o, 4);
+        }
+        return (h & 0x8000u) ? -f : f;
+    }
+    static float halfToFloat(int16_t h) {
+        return halfToFloat(static_cast<uint16_t>(h));
+    }
+};
+
 struct TriDelay : Module {
     enum ParamIds {
         GLOBAL_DELAY, GLOBAL_DELAY_ATT, TAP_1_DELAY, TAP_2_DELAY, TAP_3_DELAY,
@@ -103,19 +295,41 @@ struct TriDelay : Module {
     };
  
     float sampleRate = APP->engine->getSampleRate();
-    int bufferSize = static_cast<size_t>(3.6 * sampleRate);  // max buffer size for 3.6 seconds delay
+
+    // The delay memory is allocated outside the engine thread, sized for the longest range
+    // at the highest supported sample rate and rounded up to a power of two so reads and
+    // writes wrap with a mask. The range switch only changes how far back the taps may read.
+    // Long memory trades the switch ranges for one 60 s range, sized for the current rate.
+    // storageFormat and longMemory are the settings the UI asked for; process() only
+    // reads the format and range of the memory it has actually adopted.
+    static constexpr float MAX_DELAY_SECONDS = 3.6f;
+    static constexpr float MAX_SAMPLE_RATE = 192000.f;
+    static constexpr float LONG_DELAY_SECONDS = 60.f;
+    TriDelayMemory::Format storageFormat = TriDelayMemory::FLOAT32;
+    bool longMemory = false;
+    int rangeSamples = 1;       // Current range length in samples (hold loop and display sweep)
+    int displayIndex = 0;       // Position of the display sweep within the range
 
     float tapDelay[3] = {0.f, 0.f, 0.f};
     float tapPan[3] = {0.f, 0.f, 0.f};
-    float lastOutputL[3] = {0.f, 0.f, 0.f};
-    float lastOutputR[3] = {0.f, 0.f, 0.f};
-
-    // Delay buffer for stereo (left and right) as dynamic arrays
-    std::vector<float> buffer[2];  // Two vectors for left and right audio channels
-    int bufferIndex = 0;           // Buffer write position
+    float_4 lastInputL = 0.f;  // Previous saturator input per tap, one tap per lane
+    float_4 lastInputR = 0.f;
+
+    // Delay memory for stereo (left and right). A replacement is built on the UI thread
+    // and handed over through pendingMemory, carrying its format and range with it; the
+    // one it replaces goes back through retiredMemory to be freed by the next setMemory(),
+    // the widget, or a sample rate change, so process() never allocates or frees. Long
+    // memory outgrown by a sample rate change is rebuilt the same way, from the widget.
+    TriDelayMemory* memory = nullptr;
+    std::atomic<TriDelayMemory*> pendingMemory{nullptr};
+    std::atomic<TriDelayMemory*> retiredMemory{nullptr};
+    std::atomic<bool> memoryResizeWanted{false};
+    uint32_t bufferIndex = 0;      // Buffer write position
     
     // For clearing the buffer and holding the buffer
-    int clearIndex = 0;   // Tracks which part of the buffer we're clearing
+    int clearIndex = 0;   // How many samples behind clearStart have been cleared
+    int clearSpan = 0;    // How many samples back the taps can reach, which is all that needs clearing
+    uint32_t clearStart = 0;  // Write position when clearing began
     bool bufferClearing = false;  // Flag to indicate if the buffer is being cleared
     bool holdBuffer = false;  // Flag to hold the buffer for looping
     int clearBatchSize = 64;  // How many samples to clear per process call (tune as needed)
@@ -152,6 +366,8 @@ struct TriDelay : Module {
     json_t* toJson() override {
         json_t* rootJ = Module::toJson();
         json_object_set_new(rootJ, "delayLength", json_real(delayLength));
+        json_object_set_new(rootJ, "storageFormat", json_integer(storageFormat));
+        json_object_set_new(rootJ, "longMemory", json_boolean(longMemory));
         return rootJ;
     }
 
@@ -161,6 +377,17 @@ struct TriDelay : Module {
         json_t* delayLengthJ = json_object_get(rootJ, "delayLength");
         if (delayLengthJ)
             delayLength = json_real_value(delayLengthJ);
+
+        TriDelayMemory::Format format = storageFormat;
+        bool isLong = longMemory;
+        json_t* storageFormatJ = json_object_get(rootJ, "storageFormat");
+        if (storageFormatJ)
+            format = (TriDelayMemory::Format) clamp((int) json_integer_value(storageFormatJ), 0, TriDelayMemory::NUM_FORMATS - 1);
+        json_t* longMemoryJ = json_object_get(rootJ, "longMemory");
+        if (longMemoryJ)
+            isLong = json_is_true(longMemoryJ);
+        if (format != storageFormat || isLong != longMemory)
+            setMemory(format, isLong);
     }  
     
     //For the display
@@ -169,9 +396,8 @@ struct TriDelay : Module {
     TriDelay() : Module() {
         config(NUM_PARAMS, NUM_INPUTS, NUM_OUTPUTS, NUM_LIGHTS);
 
-        // Initialize buffer size at startup
-        buffer[0].resize(bufferSize, 0.f);
-        buffer[1].resize(bufferSize, 0.f);
+        // Allocate the delay memory at startup
+        memory = new TriDelayMemory(storageFormat, longMemory, memorySamplesNeeded(longMemory));
 
         configSwitch(DELAY_SELECT, 0.0, 2.0, 2.0, "Buffer Length (ms)", {"36", "360", "3600"});
 
@@ -224,37 +450,81 @@ struct TriDelay : Module {
         configOutput(AUDIO_OUTPUT_R, "Audio R");
     }
 
-    // Handle sample rate changes
+    ~TriDelay() {
+        delete memory;
+        delete pendingMemory.exchange(nullptr);
+        delete retiredMemory.exchange(nullptr);
+    }
+
+    // Handle sample rate changes. The engine holds process() off while this runs,
+    // so any queued memory is adopted and the old one freed right here, headless
+    // or not. The standard memory is already sized for the highest supported
+    // rate, so nothing is reallocated or copied. Long memory is sized for the
+    // rate in use; if it is now too small the UI thread is asked to rebuild it,
+    // which clears the delay, and maxDelaySamples() keeps the taps inside the
+    // current ring until the new one arrives.
     void onSampleRateChange() override {
         sampleRate = APP->engine->getSampleRate();
-        int newBufferSize = static_cast<size_t>(3.6 * sampleRate); // Resize buffer
-        resizeBuffer(newBufferSize);
+        collectRetiredMemory();
+        adoptPendingMemory();
+        collectRetiredMemory();
+        if (memory->longMemory && memory->capacity < memorySamplesNeeded(true))
+            memoryResizeWanted = true;
+    }
+
+    uint32_t memorySamplesNeeded(bool isLong) {
+        float samples = isLong ? LONG_DELAY_SECONDS * std::max(sampleRate, 44100.f)
+                               : MAX_DELAY_SECONDS * MAX_SAMPLE_RATE;
+        return static_cast<uint32_t>(samples) + TriDelayMemory::BLOCK_SIZE + 4;
+    }
 
+    // Bytes the delay memory takes with the current settings, for the menu
+    size_t memoryBytes() {
+        uint32_t capacity = 1;
+        while (capacity < memorySamplesNeeded(longMemory)) capacity <<= 1;
+        return 2 * (size_t) capacity * TriDelayMemory::bytesPerSample(storageFormat);
     }
 
-    // Resize the delay buffer for both channels, preserving old content
-    void resizeBuffer(int newBufferSize) {
-        // Copy old buffer content to a temporary buffer
-        std::vector<float> tempBufferL = buffer[0];
-        std::vector<float> tempBufferR = buffer[1];
+    // UI thread: build the memory for a new format or range and queue it for process().
+    // The format and range travel inside the memory, so process() switches all three at once.
+    void setMemory(TriDelayMemory::Format format, bool isLong) {
+        storageFormat = format;
+        longMemory = isLong;
+        memoryResizeWanted = false;
+        collectRetiredMemory();
+        // A request process() has not picked up yet is simply replaced
+        delete pendingMemory.exchange(new TriDelayMemory(format, isLong, memorySamplesNeeded(isLong)));
+    }
 
-        // Resize both buffers to the new buffer size
-        buffer[0].resize(newBufferSize, 0.f);
-        buffer[1].resize(newBufferSize, 0.f);
+    // UI thread: free memory that process() has swapped out
+    void collectRetiredMemory() {
+        delete retiredMemory.exchange(nullptr);
+    }
 
-        // Copy the data from the old buffer into the resized buffer, preserving wrap-around
-        for (int i = 0; i < std::min(bufferSize, newBufferSize); ++i) {
-            buffer[0][i] = tempBufferL[(bufferIndex + i) % bufferSize];
-            buffer[1][i] = tempBufferR[(bufferIndex + i) % bufferSize];
-        }
+    // Engine thread: swap in queued memory once the previous swap has been collected
+    void adoptPendingMemory() {
+        if (!pendingMemory.load(std::memory_order_relaxed) || retiredMemory.load())
+            return;
+        TriDelayMemory* next = pendingMemory.exchange(nullptr);
+        if (!next)
+            return;
+        retiredMemory.store(memory);
+        memory = next;
+        bufferIndex = 0;
+        bufferClearing = false;
+    }
 
-        // Update buffer size to the new value
-        bufferSize = newBufferSize;
-        // Ensure the bufferIndex doesn't exceed the new bufferSize
-        bufferIndex = bufferIndex % bufferSize;
+    // Longest delay, in samples, the taps may read at the current sample rate.
+    // The last block before the write head is kept out of reach, since an
+    // INT16_BLOCK block is rescaled as soon as the head enters it.
+    float maxDelaySamples() {
+        float seconds = memory->longMemory ? LONG_DELAY_SECONDS : MAX_DELAY_SECONDS;
+        return std::min(seconds * sampleRate, (float)(memory->capacity - TriDelayMemory::BLOCK_SIZE - 4));
     }
     
     void process(const ProcessArgs& args) override {
+        adoptPendingMemory();
+
         // Determine if the inputs are connected
         bool isConnectedL = inputs[AUDIO_INPUT_L].isConnected();
         bool isConnectedR = inputs[AUDIO_INPUT_R].isConnected();
@@ -280,23 +550,19 @@ struct TriDelay : Module {
             inputR = inputs[AUDIO_INPUT_R].getVoltage();
         }
 
-        //Read the Buffer switch value and update bufferSize
+        //Read the Buffer switch value; it sets the read range, the delay memory is untouched
         float bufferSetting = std::roundf(params[DELAY_SELECT].getValue());
-        if ( bufferSetting == 0.0f ){
+        if ( memory->longMemory ){
+            delayLength = LONG_DELAY_SECONDS * 1000.f;
+        } else if ( bufferSetting == 0.0f ){
             delayLength = 36.0f;
-            bufferSize = static_cast<size_t>( delayLength / 1000 * sampleRate );
         } else if ( bufferSetting == 1.0f ){
             delayLength = 360.f;
-            bufferSize = static_cast<size_t>( delayLength / 1000 * sampleRate );
         } else {
             delayLength = 3600.f;
-            bufferSize = static_cast<size_t>( delayLength / 1000 * sampleRate );
         }
-    
-        paramQuantities[GLOBAL_DELAY]->displayMultiplier = static_cast<int> (delayLength);
-        paramQuantities[TAP_1_DELAY]->displayMultiplier = static_cast<int> (delayLength);
-        paramQuantities[TAP_2_DELAY]->displayMultiplier = static_cast<int> (delayLength);
-        paramQuantities[TAP_3_DELAY]->displayMultiplier = static_cast<int> (delayLength);       
+        rangeSamples = std::max(1, static_cast<int>( std::min(delayLength / 1000 * sampleRate, maxDelaySamples()) ));
+        if (displayIndex >= rangeSamples) displayIndex = 0;
     
         // Global delay (with CV and attenuverter)
         float globalDelay = params[GLOBAL_DELAY].getValue() * 0.001f * delayLength; // Convert to seconds
@@ -331,7 +597,10 @@ struct TriDelay : Module {
         // Start buffer clearing process if the clear button is pressed
         if (clearButton > 0 && !bufferClearing) {
             bufferClearing = true;  // Set the flag to start clearing
-            clearIndex = 0;         // Start clearing from the beginning
+            clearIndex = 0;         // Start clearing just behind the write head
+            clearStart = bufferIndex;
+            clearSpan = static_cast<int>(maxDelaySamples()) + 4;
+            clearBatchSize = std::max(64, clearSpan / 2048); // Long memory clears in about the same time
         }
         
         // Hold buffer logic for looping
@@ -341,8 +610,7 @@ struct TriDelay : Module {
         if (bufferClearing) {
             inputL = 0.f;
             inputR = 0.f;  
-            buffer[0][bufferIndex]=0.f;
-            buffer[1][bufferIndex]=0.f;
+            memory->clear(bufferIndex);
             clearBufferIncrementally();
         }    
         
@@ -351,20 +619,20 @@ struct TriDelay : Module {
         stereoBuffer[1] = 0.f;
 
         if (holdBuffer){
-            inputL = buffer[0][bufferIndex];
-            inputR = buffer[1][bufferIndex];
+            // Loop the last range's worth of audio
+            uint32_t loopIndex = bufferIndex - rangeSamples;
+            inputL = memory->read(0, loopIndex);
+            inputR = memory->read(1, loopIndex);
         }
  
         float feedbackAccumL = 0.f;
         float feedbackAccumR = 0.f;
     
-        // Process each tap (L and R independently for stereo delay)
-        for (int i = 0; i < 3; i++) {
-            processTap(i, tapDelay[i], tapFeedback[i], tapPan[i], inputL, inputR, feedbackAccumL, feedbackAccumR);
-        }
+        // Process all taps (L and R independently for stereo delay)
+        processTaps(feedbackAccumL, feedbackAccumR);
 
-        buffer[0][bufferIndex] = clamp(inputL + feedbackAccumL, -10.f, 10.f);
-        buffer[1][bufferIndex] = clamp(inputR + feedbackAccumR, -10.f, 10.f);
+        memory->write(0, bufferIndex, clamp(inputL + feedbackAccumL, -10.f, 10.f));
+        memory->write(1, bufferIndex, clamp(inputR + feedbackAccumR, -10.f, 10.f));
     
         // Mix Wet/Dry signal for each channel
         float outputL = (1.0f - wetDry) * inputL + wetDry * stereoBuffer[0];  // Dry/Wet mix for left channel
@@ -393,7 +661,7 @@ struct TriDelay : Module {
         filteredEnvelopeWetR = alpha * envPeakWetR + (1 - alpha) * filteredEnvelopeWetR; 
 
         //Wave display
-        float progress = bufferIndex/((delayLength/1000.f)*sampleRate);
+        float progress = displayIndex / (float)rangeSamples;
         oscPhase = clamp(progress, 0.f, 1.f);
         int sampleIndex = static_cast<int>(oscPhase * 1024); 
         sampleIndex = (sampleIndex) % 1024;
@@ -405,58 +673,69 @@ struct TriDelay : Module {
         outputs[AUDIO_OUTPUT_R].setVoltage(outputValueR);
     
         // Increment buffer index (circular buffer wrap-around)
-        bufferIndex = (bufferIndex + 1) % bufferSize;
-        
-        bufferSize = static_cast<size_t>(delayLength/1000 * sampleRate);
+        bufferIndex = (bufferIndex + 1) & memory->mask;
+        if (++displayIndex >= rangeSamples) displayIndex = 0;
     }
 
-    void processTap(int tapIndex, float delayTime, float feedback, float pan, float inputL, float inputR, float& feedbackL, float& feedbackR) {
-        float delaySamples = delayTime * sampleRate;
-        int wholeDelaySamples = static_cast<int>(delaySamples);  // Integer part of delay
-        float fractionalDelay = delaySamples - wholeDelaySamples; // Fractional part of delay
-    
-        // Use Lagrange interpolation for fractional delays
-        int readIndex0 = (bufferIndex - wholeDelaySamples - 1 + bufferSize) % bufferSize;
-        int readIndex1 = (bufferIndex - wholeDelaySamples + bufferSize) % bufferSize;
-        int readIndex2 = (bufferIndex - wholeDelaySamples + 1 + bufferSize) % bufferSize;
-        int readIndex3 = (bufferIndex - wholeDelaySamples + 2 + bufferSize) % bufferSize;
+    // All three taps in one float_4 pass, one tap per lane. Lane 3 is a spare
+    // (muted) lane, free for a fourth tap or a modulated read.
+    void processTaps(float& feedbackL, float& feedbackR) {
+        const float_4 tapActive = float_4(1.f, 1.f, 1.f, 0.f);
+        float_4 delayTime = float_4(tapDelay[0], tapDelay[1], tapDelay[2], 0.f);
+        float_4 feedback = float_4(tapFeedback[0], tapFeedback[1], tapFeedback[2], 0.f);
+        float_4 pan = float_4(tapPan[0], tapPan[1], tapPan[2], 0.f);
+
+        float_4 delaySamples = simd::fmin(delayTime * sampleRate, maxDelaySamples());
+        float_4 wholeDelaySamples = simd::floor(delaySamples);  // Integer part of delay
+        float_4 fractionalDelay = delaySamples - wholeDelaySamples; // Fractional part of delay
+
+        // Gather the four Lagrange points of every tap: y[k] lane i is point k of tap i
+        uint32_t readIndex[4];
+        for (int t = 0; t < 4; t++) {
+            readIndex[t] = bufferIndex - static_cast<uint32_t>(wholeDelaySamples[t]) - 1;
+        }
+        float_4 yL[4], yR[4];
+        memory->gather(readIndex, yL, yR);
 
-        float delayedSampleL = lagrangeInterpolate(buffer[0][readIndex0], buffer[0][readIndex1], buffer[0][readIndex2], buffer[0][readIndex3], fractionalDelay);
-        float delayedSampleR = lagrangeInterpolate(buffer[1][readIndex0], buffer[1][readIndex1], buffer[1][readIndex2], buffer[1][readIndex3], fractionalDelay);
+        // Use Lagrange interpolation for fractional delays
+        float_4 L[4];
+        lagrangeWeights(fractionalDelay, L);
+        float_4 delayedSampleL = L[0] * yL[0] + L[1] * yL[1] + L[2] * yL[2] + L[3] * yL[3];
+        float_4 delayedSampleR = L[0] * yR[0] + L[1] * yR[1] + L[2] * yR[2] + L[3] * yR[3];
 
-        float scaledPan = (pan + 1.f) * 0.5f;  
+        float_4 scaledPan = (pan + 1.f) * 0.5f;  
         // Apply equal-power panning
-        float panLeft = polyCos(M_PI_2 * scaledPan);  // π/2 * scaledPan ranges from 0 to π/2
-        float panRight = polySin(M_PI_2 * scaledPan);
+        float_4 panLeft = polyCos(float(M_PI_2) * scaledPan);  // π/2 * scaledPan ranges from 0 to π/2
+        float_4 panRight = polySin(float(M_PI_2) * scaledPan);
 
         // Apply ADAA
         float maxHeadRoom = 1.31f * 5.f; //exceeding this number results in strange wavefolding due to the polytanh bad fit beyond this point
-        delayedSampleL = clamp(delayedSampleL, -maxHeadRoom, maxHeadRoom);
-        delayedSampleR = clamp(delayedSampleR, -maxHeadRoom, maxHeadRoom);
-        delayedSampleL = applyADAA(delayedSampleL/5.f, lastOutputL[tapIndex], sampleRate); //max is 2x5V
-        delayedSampleR = applyADAA(delayedSampleR/5.f, lastOutputR[tapIndex], sampleRate);
-        lastOutputL[tapIndex] = delayedSampleL;
-        lastOutputR[tapIndex] = delayedSampleR; 
-        delayedSampleL *= 5.f; 
-        delayedSampleR *= 5.f; 
+        float_4 tapInL = simd::clamp(delayedSampleL, -maxHeadRoom, maxHeadRoom) / 5.f; //max is 2x5V
+        float_4 tapInR = simd::clamp(delayedSampleR, -maxHeadRoom, maxHeadRoom) / 5.f;
+        delayedSampleL = applyADAA(tapInL, lastInputL) * 5.f * tapActive;
+        delayedSampleR = applyADAA(tapInR, lastInputR) * 5.f * tapActive;
+        lastInputL = tapInL;
+        lastInputR = tapInR;
 
         // Accumulate feedback contributions instead of writing to buffer
-        feedbackL += feedback * (delayedSampleL * panLeft + delayedSampleR * (1.0f - panRight));
-        feedbackR += feedback * (delayedSampleL * (1.0f - panLeft) + delayedSampleR * panRight);
+        float_4 tapFeedbackL = feedback * (delayedSampleL * panLeft + delayedSampleR * (1.0f - panRight));
+        float_4 tapFeedbackR = feedback * (delayedSampleL * (1.0f - panLeft) + delayedSampleR * panRight);
+        feedbackL += tapFeedbackL[0] + tapFeedbackL[1] + tapFeedbackL[2] + tapFeedbackL[3];
+        feedbackR += tapFeedbackR[0] + tapFeedbackR[1] + tapFeedbackR[2] + tapFeedbackR[3];
     
         // Accumulate the delayed signals into the stereo output buffer
-        stereoBuffer[0] += delayedSampleL;
-        stereoBuffer[1] += delayedSampleR;
-
+        stereoBuffer[0] += delayedSampleL[0] + delayedSampleL[1] + delayedSampleL[2] + delayedSampleL[3];
+        stereoBuffer[1] += delayedSampleR[0] + delayedSampleR[1] + delayedSampleR[2] + delayedSampleR[3];
     }
  
+    // Walks backwards from where the write head was when clearing began. The
+    // head writes silence forwards meanwhile, so the whole readable span ends up zeroed.
     void clearBufferIncrementally() {
-        if (clearIndex < bufferSize) {
+        if (clearIndex < clearSpan) {
             // Clear a small batch of samples in both left and right channels
-            for (int i = 0; i < clearBatchSize && clearIndex < bufferSize; ++i) {
-                buffer[0][clearIndex] = 0.0f;  // Set values to zero
-                buffer[1][clearIndex] = 0.0f;        
-                ++clearIndex;  // Move to the next sample
+            for (int i = 0; i < clearBatchSize && clearIndex < clearSpan; ++i) {
+                memory->clear(clearStart - 1 - clearIndex);  // Set values to zero
+                ++clearIndex;  // Move to the previous sample
             }
         } else {
             // If the buffer is fully cleared, stop clearing
@@ -465,42 +744,48 @@ struct TriDelay : Module {
         }
     }
 
-    // Lagrange interpolation for 4 points
-    float lagrangeInterpolate(float y0, float y1, float y2, float y3, float fraction) {
-        float L0 = ((fraction - 1.0f) * (fraction - 2.0f) * (fraction - 3.0f)) / -6.0f;
-        float L1 = ((fraction) * (fraction - 2.0f) * (fraction - 3.0f)) / 2.0f;
-        float L2 = ((fraction) * (fraction - 1.0f) * (fraction - 3.0f)) / -2.0f;
-        float L3 = ((fraction) * (fraction - 1.0f) * (fraction - 2.0f)) / 6.0f;
-    
-        return L0 * y0 + L1 * y1 + L2 * y2 + L3 * y3;
+    // Lagrange basis weights for 4 points, sharing the partial products
+    void lagrangeWeights(float_4 fraction, float_4* L) {
+        float_4 d1 = fraction - 1.0f;
+        float_4 d2 = fraction - 2.0f;
+        float_4 d3 = fraction - 3.0f;
+        float_4 d2d3 = d2 * d3;
+        float_4 fd1 = fraction * d1;
+        L[0] = d1 * d2d3 * (-1.0f/6.0f);
+        L[1] = fraction * d2d3 * 0.5f;
+        L[2] = fd1 * d3 * -0.5f;
+        L[3] = fd1 * d2 * (1.0f/6.0f);
     }
     
-    float applyADAA(float input, float lastInput, float sampleRate) {
-        float delta = input - lastInput;
-        if (fabs(delta) > 1e-6) {
-            return (antiderivative(input) - antiderivative(lastInput)) / delta;
-        } else {
-            return polyTanh(input);
-        }
+    float_4 applyADAA(float_4 input, float_4 lastInput) {
+        float_4 delta = input - lastInput;
+        float_4 useADAA = simd::fabs(delta) > 1e-6f;
+        float_4 safeDelta = simd::ifelse(useADAA, delta, 1.f);
+        float_4 adaa = (antiderivative(input) - antiderivative(lastInput)) / safeDelta;
+        return simd::ifelse(useADAA, adaa, polyTanh(input));
     }
 
-    float antiderivative(float x) {
-        float x2 = x * x;
+    template <typename T>
+    T antiderivative(T x) {
+        T x2 = x * x;
         return x2 * (0.5f - x2 * (1.0f/12.0f - x2 * (1.0f/45.0f - 17.0f/2520.0f * x2)));
     }
     
-    float polyTanh(float x) {
-        float x2 = x * x;
+    template <typename T>
+    T polyTanh(T x) {
+        T x2 = x * x;
         return x - x * x2 * (1.0f/3.0f - x2 * (2.0f/15.0f - 17.0f/315.0f * x2));
     }
     
-    float polySin(float x) {
-        float x2 = x * x;
+    template <typename T>
+    T polySin(T x) {
+        T x2 = x * x;
         return x - x * x2 * (1.0f/6.0f - x2 * (1.0f/120.0f - x2 / 5040.0f));
     }
     
-    float polyCos(float x) {
-        float x2 = x * x;
+    template <typename T>
+    T polyCos(T x) {
+        T x2 = x * x;
         return 1.0f - x2 * (0.5f - x2 * (1.0f/24.0f - x2 / 720.0f));
     }
 };
@@ -651,6 +936,25 @@ struct TriDelayWidget : ModuleWidget {
 
     }  
     
+    // Keep the delay knobs' readouts in ms for the current range. Done here on
+    // the UI thread rather than in process().
+    void step() override {
+        TriDelay* module = dynamic_cast<TriDelay*>(this->module);
+        if (module) {
+            float multiplier = static_cast<int> (module->delayLength);
+            module->paramQuantities[TriDelay::GLOBAL_DELAY]->displayMultiplier = multiplier;
+            module->paramQuantities[TriDelay::TAP_1_DELAY]->displayMultiplier = multiplier;
+            module->paramQuantities[TriDelay::TAP_2_DELAY]->displayMultiplier = multiplier;
+            module->paramQuantities[TriDelay::TAP_3_DELAY]->displayMultiplier = multiplier;
+
+            // Delay memory housekeeping that must stay off the engine thread
+            module->collectRetiredMemory();
+            if (module->memoryResizeWanted)
+                module->setMemory(module->storageFormat, module->longMemory);
+        }
+        ModuleWidget::step();
+    }
+    
     void appendContextMenu(Menu* menu) override {
         ModuleWidget::appendContextMenu(menu);
     
@@ -663,10 +967,17 @@ struct TriDelayWidget : ModuleWidget {
         struct DelayLengthItem : MenuItem {
             TriDelay* module;
             float length;
+            int setting;
             void onAction(const event::Action& e) override {
+                if (setting < 0) {
+                    module->setMemory(module->storageFormat, true);
+                } else {
+                    if (module->longMemory)
+                        module->setMemory(module->storageFormat, false);
+                    // The range switch drives delayLength, so move the switch
+                    module->params[TriDelay::DELAY_SELECT].setValue(setting);
+                }
                 module->delayLength = length;
-                module->bufferSize = static_cast<size_t>(length/1000 * module->sampleRate);
-
             }
             void step() override {
                 rightText = (module->delayLength == length) ? "✔" : "";
@@ -681,12 +992,49 @@ struct TriDelayWidget : ModuleWidget {
             { "3600 ms", 3600.0f }
         };
     
-        for (const auto& option : delayOptions) {
-            DelayLengthItem* item = createMenuItem<DelayLengthItem>(option.first);
+        for (int i = 0; i < 3; i++) {
+            DelayLengthItem* item = createMenuItem<DelayLengthItem>(delayOptions[i].first);
+            item->module = module;
+            item->length = delayOptions[i].second;
+            item->setting = i;
+            menu->addChild(item);
+        }
+
+        DelayLengthItem* longItem = createMenuItem<DelayLengthItem>("60 s (long memory)");
+        longItem->module = module;
+        longItem->length = TriDelay::LONG_DELAY_SECONDS * 1000.f;
+        longItem->setting = -1;
+        menu->addChild(longItem);
+
+        menu->addChild(new MenuSeparator());
+        menu->addChild(createMenuLabel("Delay Memory Format"));
+
+        struct StorageFormatItem : MenuItem {
+            TriDelay* module;
+            TriDelayMemory::Format format;
+            void onAction(const event::Action& e) override {
+                if (module->storageFormat != format)
+                    module->setMemory(format, module->longMemory);
+            }
+            void step() override {
+                rightText = (module->storageFormat == format) ? "✔" : "";
+                MenuItem::step();
+            }
+        };
+
+        std::pair<const char*, TriDelayMemory::Format> formatOptions[] = {
+            { "32-bit float", TriDelayMemory::FLOAT32 },
+            { "16-bit, block scaled", TriDelayMemory::INT16_BLOCK },
+            { "16-bit half float", TriDelayMemory::FLOAT16 }
+        };
+
+        for (const auto& option : formatOptions) {
+            StorageFormatItem* item = createMenuItem<StorageFormatItem>(option.first);
             item->module = module;
-            item->length = option.second;
+            item->format = option.second;
             menu->addChild(item);
         }
+        menu->addChild(createMenuLabel(string::f("Uses %.1f MB; changing format, or the sample rate in long mode, clears the delay", module->memoryBytes() / (1024.f * 1024.f))));
     }
       
 };
@@ -11,8 +11,11 @@
 
 #include "rack.hpp"
 #include "plugin.hpp"
+#include "dsp/fft.hpp"
 #include <cmath>
 #include <string>
+#include <memory>
+#include <atomic>
 #include "digital_display.hpp"
 
 using namespace rack;
@@ -50,6 +53,27 @@ public:
 //
 // Smoothing only runs on confident results, preventing stale or default
 // values from leaking into the display when no signal is present.
+//
+// FFT engine: the same normalised autocorrelation, but every lag at once via
+// Wiener-Khinchin.  For a window w over the first half of the frame x,
+//   num[L] = sum_i w[i]^2 x[i] x[i+L]   = xcorr(w^2 x, x)[L]
+//   sqL[L] = sum_i w[i]^2 x[i+L]^2      = xcorr(w^2, x^2)[L]
+// Both are products of zero-padded real spectra (i + L < bufferSize, so a
+// transform of the next power of two up never wraps).  One analysis is a
+// handful of FFT steps, one per sample, so it can re-run every
+// bufferSize / FFT_OVERLAP decimated samples instead of once per fill.
+//
+// YIN detector: either engine, run with a rectangular window, yields the
+// cross term r[L] = sum_{i<W} x[i] x[i+L].  It is recomputed for every frame,
+// not slid per sample: O(N^2) per analysis in the time-domain engine (spread
+// over samples by the budget) and O(N log N) in the FFT engine, which is the
+// better pairing for YIN.  The YIN difference function
+//   d[L] = sum x[i]^2 + sum x[i+L]^2 - 2 r[L]
+// then needs only running sums for the energies, and its cumulative mean
+// normalisation d'[L] = d[L] * L / sum_{j<=L} d[j] is another running sum,
+// so only the finishing stage after r[L] is O(N).  The pitch is the first dip of d'
+// below YIN_THRESHOLD, followed down to its minimum and refined with a
+// parabola through d.  1 - d' at that lag stands in for the AC peak as confidence.
 // ---------------------------------------------------------------------------
 struct DecimatedFrequencyTracker {
 
@@ -62,6 +86,36 @@ struct DecimatedFrequencyTracker {
     static constexpr int MAX_BUFFER_SIZE = 1500;
     int bufferSize = MAX_BUFFER_SIZE;
 
+    enum Engine {
+        TIME_DOMAIN_ENGINE,
+        FFT_ENGINE,
+        ENGINES_LEN
+    };
+    int engine = TIME_DOMAIN_ENGINE;
+
+    enum Detector {
+        AUTOCORRELATION_DETECTOR,
+        YIN_DETECTOR,
+        DETECTORS_LEN
+    };
+    int detector = AUTOCORRELATION_DETECTOR;
+    static constexpr float YIN_THRESHOLD = 0.15f;
+    static constexpr int FFT_OVERLAP  = 4;
+    static constexpr int MAX_FFT_SIZE = 2048;  // next power of two >= MAX_BUFFER_SIZE
+    int hopCounter = 0;
+    bool bufferFilled = false;  // FFT engine waits for one full frame of real input
+
+    // FFT engine buffers, allocated once at MAX_FFT_SIZE (pffft needs them
+    // aligned). The plan follows the buffer geometry whichever engine runs,
+    // so switching engines never allocates.
+    std::unique_ptr<dsp::RealFFT> fft;
+    int    fftSize     = 0;
+    float* fftTime     = nullptr;   // zero-padded time-domain scratch
+    float* fftSpectrum = nullptr;   // spectrum of x, then of x^2 and sqL
+    float* fftNum      = nullptr;   // num spectrum, then num[L] (unscaled)
+    float* fftWeight   = nullptr;   // spectrum of w^2, rebuilt with the window
+    float  fftSq0      = 0.f;
+
     float writeBuffer[MAX_BUFFER_SIZE]   = {};
     float processBuffer[MAX_BUFFER_SIZE] = {};
     int   writeIndex = 0;
@@ -71,10 +125,12 @@ struct DecimatedFrequencyTracker {
     int   decimationFactor = 8;
 
     // Incremental AC engine.
-    // States: 0=idle, 1=mean, 2=dc-remove, 3=correlate, 4=peak-scan, 5=candidate+finalize
+    // States: 0=idle, 1=mean, 2=dc-remove, 3=correlate, 4=peak-scan, 5=candidate+finalize,
+    //         6=FFT engine correlation (replaces 3), 7=YIN finalize (replaces 4 and 5)
     std::vector<float> ac;
     std::vector<float> win;
     std::vector<float> dcRemovedSignal;
+    std::vector<float> yinDiff;   // YIN difference function d[L], for refinement
     int   acState = 0;
     int   acLag   = 1;
     int   acHalf  = 0;
@@ -116,12 +172,27 @@ struct DecimatedFrequencyTracker {
     float smoothFactor = 0.9995f;
 
     DecimatedFrequencyTracker() {
+        fftTime     = static_cast<float*>(pffft_aligned_malloc(MAX_FFT_SIZE * sizeof(float)));
+        fftSpectrum = static_cast<float*>(pffft_aligned_malloc(MAX_FFT_SIZE * sizeof(float)));
+        fftNum      = static_cast<float*>(pffft_aligned_malloc(MAX_FFT_SIZE * sizeof(float)));
+        fftWeight   = static_cast<float*>(pffft_aligned_malloc(MAX_FFT_SIZE * sizeof(float)));
         ac.resize(MAX_BUFFER_SIZE / 2, 0.f);
+        yinDiff.resize(MAX_BUFFER_SIZE / 2, 0.f);
         win.resize(MAX_BUFFER_SIZE / 2, 0.f);
         dcRemovedSignal.resize(MAX_BUFFER_SIZE, 0.f);
         rebuildWindow();
     }
 
+    ~DecimatedFrequencyTracker() {
+        pffft_aligned_free(fftTime);
+        pffft_aligned_free(fftSpectrum);
+        pffft_aligned_free(fftNum);
+        pffft_aligned_free(fftWeight);
+    }
+
+    DecimatedFrequencyTracker(const DecimatedFrequencyTracker&) = delete;
+    DecimatedFrequencyTracker& operator=(const DecimatedFrequencyTracker&) = delete;
+
     void setDecimation(int factor, float fullSampleRate, float minFrequency = 16.f) {
         decimationFactor    = std::max(1, factor);
         decimatedSampleRate = fullSampleRate / decimationFactor;
@@ -151,11 +222,31 @@ struct DecimatedFrequencyTracker {
         bufferReady = false;
         chunkPos    = 0;
         writeIndex  = 0;
+        hopCounter  = 0;
+        bufferFilled = false;
         decimAccum  = 0.f;
         decimCount  = 0;
         analysisSkipCounter = 0;
     }
 
+    void setEngine(int newEngine) {
+        if (newEngine == engine) return;
+        engine      = clamp(newEngine, 0, ENGINES_LEN - 1);
+        acState     = 0;
+        bufferReady = false;
+        chunkPos    = 0;
+        hopCounter  = 0;
+    }
+
+    void setDetector(int newDetector) {
+        if (newDetector == detector) return;
+        detector    = clamp(newDetector, 0, DETECTORS_LEN - 1);
+        acState     = 0;
+        bufferReady = false;
+        chunkPos    = 0;
+        rebuildWindow();
+    }
+
     void setConfidenceFloor(float floor) { confidenceFloor = floor; }
     void setLagsPerCall(int lags) {
         lagsPerCall = std::max(1, lags);
@@ -168,35 +259,52 @@ struct DecimatedFrequencyTracker {
         simdLen = (half / 4) * 4;
         win.resize(half);
         ac.resize(half, 0.f);
+        yinDiff.resize(half, 0.f);
         dcRemovedSignal.resize(bufferSize, 0.f);
         for (int i = 0; i < half; ++i)
-            win[i] = 0.5f * (1.f - cosf(2.f * (float)M_PI * i / (half - 1)));
+            win[i] = (detector == YIN_DETECTOR) ? 1.f
+                   : 0.5f * (1.f - cosf(2.f * (float)M_PI * i / (half - 1)));
+        buildFftPlan();
+    }
+
+    // FFT engine: smallest power of two holding the frame, and the
+    // spectrum of the squared window, which never changes between frames.
+    // The plan is only rebuilt when the buffer size changes, which happens
+    // in setDecimation(), never from process().
+    void buildFftPlan() {
+        int half = bufferSize / 2;
+        int size = 64;
+        while (size < bufferSize) size *= 2;
+        if (size != fftSize) {
+            fftSize = size;
+            fft.reset(new dsp::RealFFT(fftSize));
+        }
+        std::fill(fftTime, fftTime + fftSize, 0.f);
+        for (int i = 0; i < half; ++i)
+            fftTime[i] = win[i] * win[i];
+        fft->rfft(fftTime, fftWeight);
+    }
+
+    // out = conj(x) * y, bin by bin, in RealFFT's packing:
+    // [DC, Nyquist, re1, im1, re2, im2, ...]. out may alias x or y.
+    void correlateSpectra(const float* x, const float* y, float* out) const {
+        out[0] = x[0] * y[0];
+        out[1] = x[1] * y[1];
+        for (int k = 2; k < fftSize; k += 2) {
+            float xr = x[k], xi = x[k + 1];
+            float yr = y[k], yi = y[k + 1];
+            out[k]     = xr * yr + xi * yi;
+            out[k + 1] = xr * yi - xi * yr;
+        }
     }
 
     // Returns smoothed Hz or -1 if no confident lock.
     float process(float in) {
         decimAccum += in;
         if (++decimCount >= decimationFactor) {
-            writeBuffer[writeIndex++] = decimAccum / decimationFactor;
+            pushDecimated(decimAccum / decimationFactor);
             decimAccum = 0.f;
             decimCount = 0;
-            if (writeIndex >= bufferSize) {
-                writeIndex = 0;
-                if (acState == 0) {
-                    // Skip N buffer fills between analyses to reduce CPU.
-                    // Each skipped fill costs nothing -- we just keep writing
-                    // into the write buffer and discard it.
-                    if (++analysisSkipCounter > analysisSkip) {
-                        analysisSkipCounter = 0;
-                        std::memcpy(processBuffer, writeBuffer, bufferSize * sizeof(float));
-                        bufferReady = true;
-                        acHalf      = bufferSize / 2;
-                        acMean      = 0.f;
-                        chunkPos    = 0;
-                        acState     = 1;
-                    }
-                }
-            }
         }
 
         // Run a small, fixed slice of analysis work on every full-rate sample.
@@ -207,18 +315,62 @@ struct DecimatedFrequencyTracker {
         // Only smooth when a new decimated sample was just produced --
         // running this every full-rate sample wastes CPU since the value
         // only changes once per decimationFactor samples.
-        if (decimCount == 0) {
-            if (lastFreq > 0.f) {
-                if (smoothedFreq < 0.f)
-                    smoothedFreq = lastFreq;  // cold start: snap rather than ramp
-                else
-                    smoothedFreq = smoothFactor * smoothedFreq + (1.f - smoothFactor) * lastFreq;
-            } else {
-                smoothedFreq = -1.f;
+        if (decimCount == 0) updateSmoothing();
+
+        return smoothedFreq;
+    }
+
+    // Store one decimated sample and start an analysis if a frame is due.
+    // process() calls this; PolyTrackerBank calls it directly from its
+    // shared decimator.
+    void pushDecimated(float x) {
+        writeBuffer[writeIndex++] = x;
+        if (writeIndex >= bufferSize) {
+            writeIndex   = 0;
+            bufferFilled = true;
+        }
+
+        // The time-domain engine analyses each full buffer; the FFT
+        // engine analyses the latest bufferSize samples every hop.
+        bool frameDue;
+        if (engine == FFT_ENGINE) {
+            frameDue = ++hopCounter >= bufferSize / FFT_OVERLAP && bufferFilled;
+            if (frameDue) hopCounter = 0;
+        } else {
+            frameDue = (writeIndex == 0);
+        }
+
+        if (frameDue) {
+            if (acState == 0) {
+                // Skip N buffer fills between analyses to reduce CPU.
+                // Each skipped fill costs nothing -- we just keep writing
+                // into the write buffer and discard it.
+                if (++analysisSkipCounter > analysisSkip) {
+                    analysisSkipCounter = 0;
+                    // Oldest sample first: the write buffer is circular
+                    int older = bufferSize - writeIndex;
+                    std::memcpy(processBuffer, writeBuffer + writeIndex, older * sizeof(float));
+                    std::memcpy(processBuffer + older, writeBuffer, writeIndex * sizeof(float));
+                    bufferReady = true;
+                    acHalf      = bufferSize / 2;
+                    acMean      = 0.f;
+                    chunkPos    = 0;
+                    acState     = 1;
+                }
             }
         }
+    }
 
-        return smoothedFreq;
+    // Advance the smoothed output by one decimated sample.
+    void updateSmoothing() {
+        if (lastFreq > 0.f) {
+            if (smoothedFreq < 0.f)
+                smoothedFreq = lastFreq;  // cold start: snap rather than ramp
+            else
+                smoothedFreq = smoothFactor * smoothedFreq + (1.f - smoothFactor) * lastFreq;
+        } else {
+            smoothedFreq = -1.f;
+        }
     }
 
     // Apply a finished analysis result and return to idle.
@@ -261,7 +413,11 @@ struct DecimatedFrequencyTracker {
                         dcRemovedSignal[i] = processBuffer[i] - acMean;
                     chunkPos += elems;
                     budget   -= (elems + 3) / 4;
-                    if (chunkPos >= bufferSize) {
+                    if (chunkPos >= bufferSize && engine == FFT_ENGINE) {
+                        chunkPos = 0;
+                        acState  = 6;
+                    }
+                    else if (chunkPos >= bufferSize) {
                         // No need to zero ac[] -- every ac[acLag] is written before being read
                         acLag    = 1;
                         chunkPos = 0;
@@ -299,8 +455,11 @@ struct DecimatedFrequencyTracker {
                             sq0 += a * a;
                             sqL += b * b;
                         }
-                        ac[acLag] = std::min(1.f, std::max(-1.f,
-                                        num / (sqrtf(sq0 * sqL) + 1e-12f)));
+                        if (detector == YIN_DETECTOR)
+                            ac[acLag] = num;  // cross term, recomputed per frame; finished in state 7
+                        else
+                            ac[acLag] = std::min(1.f, std::max(-1.f,
+                                            num / (sqrtf(sq0 * sqL) + 1e-12f)));
                         acLag++;
                         chunkPos = 0;
                         partNum  = float_4(0.f);
@@ -311,12 +470,136 @@ struct DecimatedFrequencyTracker {
                             acGlobalPeak    = -2.f;
                             acGlobalPeakLag = 1;
                             chunkPos        = 1;
-                            acState         = 4;
+                            acState         = (detector == YIN_DETECTOR) ? 7 : 4;
                         }
                     }
                     break;
                 }
 
+                case 6: { // FFT engine: one transform step per call
+                    const float* sig = dcRemovedSignal.data();
+                    const float* w   = win.data();
+                    switch (chunkPos) {
+                        case 0: // X = FFT(x)
+                            std::memcpy(fftTime, sig, bufferSize * sizeof(float));
+                            std::fill(fftTime + bufferSize, fftTime + fftSize, 0.f);
+                            fft->rfft(fftTime, fftSpectrum);
+                            break;
+                        case 1: // num spectrum = conj(FFT(w^2 x)) * X
+                            fftSq0 = 0.f;
+                            for (int i = 0; i < acHalf; ++i) {
+                                float a = sig[i] * w[i];
+                                fftSq0    += a * a;
+                                fftTime[i] = a * w[i];
+                            }
+                            std::fill(fftTime + acHalf, fftTime + fftSize, 0.f);
+                            fft->rfft(fftTime, fftNum);
+                            correlateSpectra(fftNum, fftSpectrum, fftNum);
+                            break;
+                        case 2: // num[L]
+                            fft->irfft(fftNum, fftTime);
+                            std::swap(fftTime, fftNum);
+                            break;
+                        case 3: // sqL spectrum = conj(FFT(w^2)) * FFT(x^2)
+                            if (detector == YIN_DETECTOR) break;  // YIN uses running sums
+                            for (int i = 0; i < bufferSize; ++i)
+                                fftTime[i] = sig[i] * sig[i];
+                            std::fill(fftTime + bufferSize, fftTime + fftSize, 0.f);
+                            fft->rfft(fftTime, fftSpectrum);
+                            correlateSpectra(fftWeight, fftSpectrum, fftSpectrum);
+                            break;
+                        case 4: // sqL[L]
+                            if (detector == YIN_DETECTOR) break;
+                            fft->irfft(fftSpectrum, fftTime);
+                            break;
+                        case 5: { // normalise; irfft is unscaled, hence 1/fftSize
+                            const float* sqL = fftTime;
+                            float norm = 1.f / fftSize;
+                            if (detector == YIN_DETECTOR) {
+                                for (int lag = 1; lag < acHalf; ++lag)
+                                    ac[lag] = fftNum[lag] * norm;
+                                break;
+                            }
+                            for (int lag = 1; lag < acHalf; ++lag) {
+                                float num = fftNum[lag] * norm;
+                                float sq  = std::max(0.f, sqL[lag] * norm);
+                                ac[lag] = std::min(1.f, std::max(-1.f,
+                                              num / (sqrtf(fftSq0 * sq) + 1e-12f)));
+                            }
+                            break;
+                        }
+                    }
+                    budget = 0;
+                    if (++chunkPos > 5) {
+                        acGlobalPeak    = -2.f;
+                        acGlobalPeakLag = 1;
+                        chunkPos        = 1;
+                        acState         = (detector == YIN_DETECTOR) ? 7 : 4;
+                    }
+                    break;
+                }
+
+                case 7: { // YIN: difference function and CMNDF from ac[] cross terms, one O(N) pass
+                    const float* sig = dcRemovedSignal.data();
+                    const int    W   = acHalf;
+
+                    double sq0 = 0.0;
+                    for (int i = 0; i < W; ++i)
+                        sq0 += (double)sig[i] * sig[i];
+
+                    // energy = sum_{i<W} x[i+lag]^2, slid one sample per lag
+                    double energy     = sq0;
+                    double runningSum = 0.0;
+                    ac[0] = 1.f;
+                    for (int lag = 1; lag < acHalf; ++lag) {
+                        energy += (double)sig[lag - 1 + W] * sig[lag - 1 + W]
+                                - (double)sig[lag - 1]     * sig[lag - 1];
+                        double d = std::max(0.0, sq0 + energy - 2.0 * ac[lag]);
+                        yinDiff[lag] = (float)d;
+                        runningSum += d;
+                        ac[lag] = (runningSum > 0.0) ? (float)(d * lag / runningSum) : 1.f;
+                    }
+
+                    // First dip below the threshold, followed down to its
+                    // minimum; failing that, the global minimum.
+                    int bestLag = 0;
+                    for (int lag = 2; lag < acHalf - 1; ++lag) {
+                        if (ac[lag] < YIN_THRESHOLD) {
+                            while (lag + 1 < acHalf - 1 && ac[lag + 1] < ac[lag]) lag++;
+                            bestLag = lag;
+                            break;
+                        }
+                    }
+                    if (bestLag == 0) {
+                        bestLag = 2;
+                        for (int lag = 3; lag < acHalf - 1; ++lag)
+                            if (ac[lag] < ac[bestLag]) bestLag = lag;
+                    }
+                    budget -= acHalf / 2;
+
+                    acPeakValue = 1.f - ac[bestLag];
+                    if (acPeakValue < confidenceFloor) {
+                        finishAnalysis(-1.f);
+                        break;
+                    }
+                    if (acPeakValue < confidenceFloor + 0.10f) {
+                        finishAnalysis(-2.f);
+                        break;
+                    }
+
+                    // Parabolic sub-sample interpolation of the minimum, on d
+                    // rather than d' (the normalisation skews the parabola)
+                    float y0    = yinDiff[bestLag - 1];
+                    float y1    = yinDiff[bestLag];
+                    float y2    = yinDiff[bestLag + 1];
+                    float denom = y0 - 2.f * y1 + y2;
+                    float shift = (fabsf(denom) > 1e-12f) ? (0.5f * (y0 - y2) / denom) : 0.f;
+                    float freq  = decimatedSampleRate / ((float)bestLag + clamp(shift, -0.5f, 0.5f));
+                    if (!(std::isfinite(freq) && freq > 0.f)) freq = -1.f;
+                    finishAnalysis(freq);
+                    break;
+                }
+
                 case 4: { // global peak scan over ac[1 .. acHalf-1]
                     int last = std::min(acHalf, chunkPos + budget * 4);
                     for (int lag = chunkPos; lag < last; ++lag) {
@@ -450,10 +733,24 @@ struct DualRangeTracker {
         lfoTracker.setAnalysisSkip(skip);
     }
 
+    void setEngine(int engine) {
+        audioTracker.setEngine(engine);
+        lfoTracker.setEngine(engine);
+    }
+
+    void setDetector(int detector) {
+        audioTracker.setDetector(detector);
+        lfoTracker.setDetector(detector);
+    }
+
     float process(float in) {
         float audioFreq = audioTracker.process(in);
         float lfoFreq   = lfoTracker.process(in);
+        return select(audioFreq, lfoFreq);
+    }
 
+    // Pick between the two trackers' smoothed results.
+    float select(float audioFreq, float lfoFreq) const {
         bool audioValid = (audioFreq > 0.f && audioTracker.acPeakValue > 0.35f);
         bool lfoValid   = (lfoFreq   > 0.f && lfoTracker.acPeakValue   > 0.25f);
 
@@ -467,6 +764,134 @@ struct DualRangeTracker {
 };
 
 
+// ---------------------------------------------------------------------------
+// PolyTrackerBank
+//
+// One DualRangeTracker per channel of a polyphonic input.  The decimation
+// front end is shared: channels are summed four at a time in float_4
+// accumulators and each decimated sample is pushed into the trackers'
+// buffers directly.
+//
+// Autocorrelation work is round-robin scheduled.  On each sample only
+// ANALYSIS_SLOTS trackers with an analysis in flight get to run a chunk, so
+// total cost levels off as channels are added: with many channels each
+// analysis takes longer and more buffer fills are skipped, which lowers the
+// update rate per channel rather than raising the CPU.  With four or fewer
+// trackers busy every one runs each sample, exactly as in mono mode.
+// ---------------------------------------------------------------------------
+struct PolyTrackerBank {
+    static constexpr int MAX_CHANNELS   = 16;
+    static constexpr int GROUPS         = MAX_CHANNELS / 4;
+    static constexpr int ANALYSIS_SLOTS = 4;
+
+    DualRangeTracker trackers[MAX_CHANNELS];
+    float hz[MAX_CHANNELS];
+
+    float_4 audioAccum[GROUPS];
+    float_4 lfoAccum[GROUPS];
+    int     audioCount = 0;
+    int     lfoCount   = 0;
+    int     nextSlot   = 0;   // round-robin position over 2 * channels trackers
+
+    PolyTrackerBank() {
+        std::fill(hz, hz + MAX_CHANNELS, -1.f);
+        resetDecimation();
+    }
+
+    void resetDecimation() {
+        for (int g = 0; g < GROUPS; g++) {
+            audioAccum[g] = float_4(0.f);
+            lfoAccum[g]   = float_4(0.f);
+        }
+        audioCount = 0;
+        lfoCount   = 0;
+    }
+
+    void setSampleRate(float sr) {
+        for (int c = 0; c < MAX_CHANNELS; c++)
+            trackers[c].setSampleRate(sr);
+        resetDecimation();
+    }
+
+    void setLagsPerCall(int lags) {
+        for (int c = 0; c < MAX_CHANNELS; c++)
+            trackers[c].setLagsPerCall(lags);
+    }
+
+    void setAnalysisSkip(int skip) {
+        for (int c = 0; c < MAX_CHANNELS; c++)
+            trackers[c].setAnalysisSkip(skip);
+    }
+
+    void setEngine(int engine) {
+        for (int c = 0; c < MAX_CHANNELS; c++)
+            trackers[c].setEngine(engine);
+    }
+
+    void setDetector(int detector) {
+        for (int c = 0; c < MAX_CHANNELS; c++)
+            trackers[c].setDetector(detector);
+    }
+
+    // in: ceil(channels / 4) float_4 groups.  Updates hz[0 .. channels-1].
+    void process(const float_4* in, int channels) {
+        int groups = (channels + 3) / 4;
+        for (int g = 0; g < groups; g++) {
+            audioAccum[g] += in[g];
+            lfoAccum[g]   += in[g];
+        }
+
+        // Decimation factors are the same for every channel
+        const int audioFactor = trackers[0].audioTracker.decimationFactor;
+        const int lfoFactor   = trackers[0].lfoTracker.decimationFactor;
+
+        bool audioTick = ++audioCount >= audioFactor;
+        if (audioTick) {
+            for (int g = 0; g < groups; g++) {
+                float_4 x = audioAccum[g] / (float)audioFactor;
+                for (int lane = 0; lane < 4 && g * 4 + lane < channels; lane++)
+                    trackers[g * 4 + lane].audioTracker.pushDecimated(x[lane]);
+                audioAccum[g] = float_4(0.f);
+            }
+            audioCount = 0;
+        }
+
+        bool lfoTick = ++lfoCount >= lfoFactor;
+        if (lfoTick) {
+            for (int g = 0; g < groups; g++) {
+                float_4 x = lfoAccum[g] / (float)lfoFactor;
+                for (int lane = 0; lane < 4 && g * 4 + lane < channels; lane++)
+                    trackers[g * 4 + lane].lfoTracker.pushDecimated(x[lane]);
+                lfoAccum[g] = float_4(0.f);
+            }
+            lfoCount = 0;
+        }
+
+        // Round-robin: even slots are audio trackers, odd slots LFO trackers
+        int slots = 2 * channels;
+        if (nextSlot >= slots) nextSlot = 0;
+        int ran = 0;
+        for (int tried = 0; tried < slots && ran < ANALYSIS_SLOTS; tried++) {
+            DualRangeTracker& t = trackers[nextSlot / 2];
+            DecimatedFrequencyTracker& tracker = (nextSlot & 1) ? t.lfoTracker : t.audioTracker;
+            if (++nextSlot >= slots) nextSlot = 0;
+            if (tracker.bufferReady) {
+                tracker.processChunk();
+                ran++;
+            }
+        }
+
+        if (!audioTick && !lfoTick) return;
+        for (int c = 0; c < channels; c++) {
+            DualRangeTracker& t = trackers[c];
+            if (audioTick) t.audioTracker.updateSmoothing();
+            if (lfoTick)   t.lfoTracker.updateSmoothing();
+            hz[c] = t.select(t.audioTracker.smoothedFreq, t.lfoTracker.smoothedFreq);
+        }
+    }
+};
+
+
 // ---------------------------------------------------------------------------
 // PhaseAccumulatorTrigger
 //
@@ -577,13 +1002,34 @@ struct Tuner : Module {
 
     int  lagsPerCall   = 8;
     int  analysisSkip  = 1;
+    int  acEngine      = DecimatedFrequencyTracker::TIME_DOMAIN_ENGINE;
+    int  activeEngine  = DecimatedFrequencyTracker::TIME_DOMAIN_ENGINE;  // engine-thread copy
+    int  detector[2]       = {DecimatedFrequencyTracker::AUTOCORRELATION_DETECTOR,
+                              DecimatedFrequencyTracker::AUTOCORRELATION_DETECTOR};
+    int  activeDetector[2] = {DecimatedFrequencyTracker::AUTOCORRELATION_DETECTOR,
+                              DecimatedFrequencyTracker::AUTOCORRELATION_DETECTOR};
     bool displayMode   = false;
 
+    // Poly mode: every channel of each input is tracked and FREQ_OUTPUT
+    // carries one V/oct per channel.  Channel 0 drives the display.  The
+    // banks are built on the UI thread the first time poly mode is enabled
+    // and handed to process() through pendingPolyBank, so the engine never
+    // allocates them.
+    bool polyMode = false;
+    bool polyBanksBuilt = false;   // UI-side
+    std::unique_ptr<PolyTrackerBank> polyBank[2];
+    std::atomic<PolyTrackerBank*> pendingPolyBank[2] = {{nullptr}, {nullptr}};
+    int  polyChannels[2] = {0, 0};
+
     json_t* dataToJson() override {
         json_t* rootJ = json_object();
         json_object_set_new(rootJ, "displayMode",   json_boolean(displayMode));
         json_object_set_new(rootJ, "lagsPerCall",   json_integer(lagsPerCall));
         json_object_set_new(rootJ, "analysisSkip",  json_integer(analysisSkip));
+        json_object_set_new(rootJ, "acEngine",      json_integer(acEngine));
+        json_object_set_new(rootJ, "polyMode",      json_boolean(polyMode));
+        json_object_set_new(rootJ, "detector1",     json_integer(detector[0]));
+        json_object_set_new(rootJ, "detector2",     json_integer(detector[1]));
         return rootJ;
     }
 
@@ -595,18 +1041,107 @@ struct Tuner : Module {
         if (j) lagsPerCall = clamp((int)json_integer_value(j), 1, 32);
         j = json_object_get(rootJ, "analysisSkip");
         if (j) analysisSkip = clamp((int)json_integer_value(j), 0, 32);
+        j = json_object_get(rootJ, "acEngine");
+        if (j) acEngine = clamp((int)json_integer_value(j), 0, DecimatedFrequencyTracker::ENGINES_LEN - 1);
+        j = json_object_get(rootJ, "polyMode");
+        if (j) setPolyMode(json_boolean_value(j));
+        for (int ch = 0; ch < 2; ch++) {
+            j = json_object_get(rootJ, ch == 0 ? "detector1" : "detector2");
+            if (j) detector[ch] = clamp((int)json_integer_value(j), 0, DecimatedFrequencyTracker::DETECTORS_LEN - 1);
+        }
         applyLagsPerCall();
         applyAnalysisSkip();
     }
 
     void applyLagsPerCall() {
-        for (int ch = 0; ch < 2; ch++)
+        for (int ch = 0; ch < 2; ch++) {
             freqTracker[ch].setLagsPerCall(lagsPerCall);
+            if (polyBank[ch]) polyBank[ch]->setLagsPerCall(lagsPerCall);
+        }
     }
 
     void applyAnalysisSkip() {
-        for (int ch = 0; ch < 2; ch++)
+        for (int ch = 0; ch < 2; ch++) {
             freqTracker[ch].setAnalysisSkip(analysisSkip);
+            if (polyBank[ch]) polyBank[ch]->setAnalysisSkip(analysisSkip);
+        }
+    }
+
+    // Called from process(), so an engine never changes under a tracker that
+    // is mid-analysis. The FFT plan is already built; this only switches.
+    void applyEngine() {
+        activeEngine = acEngine;
+        for (int ch = 0; ch < 2; ch++) {
+            freqTracker[ch].setEngine(activeEngine);
+            if (polyBank[ch]) polyBank[ch]->setEngine(activeEngine);
+        }
+    }
+
+    // Also called from process(), for the same reason as applyEngine().
+    void applyDetector(int ch) {
+        activeDetector[ch] = detector[ch];
+        freqTracker[ch].setDetector(activeDetector[ch]);
+        if (polyBank[ch]) polyBank[ch]->setDetector(activeDetector[ch]);
+    }
+
+    void configurePolyBank(PolyTrackerBank& bank, int ch) {
+        bank.setEngine(activeEngine);
+        bank.setDetector(activeDetector[ch]);
+        bank.setSampleRate(sampleRate);
+        bank.setLagsPerCall(lagsPerCall);
+        bank.setAnalysisSkip(analysisSkip);
+    }
+
+    // UI thread: switch poly mode, building the banks the first time
+    void setPolyMode(bool enabled) {
+        if (enabled && !polyBanksBuilt) {
+            polyBanksBuilt = true;
+            for (int ch = 0; ch < 2; ch++) {
+                PolyTrackerBank* bank = new PolyTrackerBank();
+                configurePolyBank(*bank, ch);
+                pendingPolyBank[ch].store(bank);
+            }
+        }
+        polyMode = enabled;
+    }
+
+    // Engine thread: take over a bank built by setPolyMode(). Settings may
+    // have changed since it was built, so they are applied again; none of
+    // these setters allocate.
+    void adoptPolyBank(int ch) {
+        PolyTrackerBank* bank = pendingPolyBank[ch].exchange(nullptr);
+        if (!bank) return;
+        polyBank[ch].reset(bank);
+        bank->setEngine(activeEngine);
+        bank->setDetector(activeDetector[ch]);
+        bank->setLagsPerCall(lagsPerCall);
+        bank->setAnalysisSkip(analysisSkip);
+    }
+
+    // Track every channel of input ch; returns channel 0 for the display.
+    float processPoly(int ch) {
+        if (!polyBank[ch]) {
+            adoptPolyBank(ch);
+            if (!polyBank[ch]) {
+                polyChannels[ch] = 0;
+                currentHz[ch] = -1.f;
+                return 0.f;
+            }
+        }
+        int channels = inputConnected[ch] ? inputs[AUDIO_INPUT + ch].getChannels() : 0;
+        polyChannels[ch] = channels;
+        if (channels == 0) {
+            currentHz[ch] = -1.f;
+            return 0.f;
+        }
+
+        float_4 in[PolyTrackerBank::GROUPS];
+        for (int c = 0; c < channels; c += 4)
+            in[c / 4] = simd::clamp(inputs[AUDIO_INPUT + ch].getPolyVoltageSimd<float_4>(c) * displayGain[ch]
+                                    + displayOffset[ch], -10.f, 10.f);
+        polyBank[ch]->process(in, channels);
+        currentHz[ch] = polyBank[ch]->hz[0];
+        return in[0][0];
     }
 
     Tuner() {
@@ -630,18 +1165,32 @@ struct Tuner : Module {
         applyAnalysisSkip();
     }
 
+    ~Tuner() {
+        for (int ch = 0; ch < 2; ch++)
+            delete pendingPolyBank[ch].exchange(nullptr);
+    }
+
+    // The engine is paused while this runs, so a pending bank is adopted
+    // here and resized with the rest.
     void onSampleRateChange() override {
         sampleRate = APP->engine->getSampleRate();
-        for (int ch = 0; ch < 2; ch++)
+        for (int ch = 0; ch < 2; ch++) {
+            adoptPolyBank(ch);
             freqTracker[ch].setSampleRate(sampleRate);
+            if (polyBank[ch]) polyBank[ch]->setSampleRate(sampleRate);
+        }
         // Re-apply user settings after setSampleRate resets the trackers
         applyLagsPerCall();
         applyAnalysisSkip();
     }
 
     void process(const ProcessArgs& args) override {
+        if (acEngine != activeEngine)
+            applyEngine();
 
         for (int ch = 0; ch < 2; ch++) {
+            if (detector[ch] != activeDetector[ch])
+                applyDetector(ch);
 
             // Read knob and input state every ~2ms to save CPU
             if (++paramReadCounter[ch] >= 100) {
@@ -654,14 +1203,29 @@ struct Tuner : Module {
             }
 
             float in = 0.f;
-            if (inputConnected[ch])
-                in = clamp(inputs[AUDIO_INPUT + ch].getVoltage(0) * displayGain[ch]
-                           + displayOffset[ch], -10.f, 10.f);
+            if (polyMode) {
+                in = processPoly(ch);
+            } else {
+                if (inputConnected[ch])
+                    in = clamp(inputs[AUDIO_INPUT + ch].getVoltage(0) * displayGain[ch]
+                               + displayOffset[ch], -10.f, 10.f);
 
-            currentHz[ch] = freqTracker[ch].process(in);
+                currentHz[ch] = freqTracker[ch].process(in);
+            }
 
             // V/oct output
-            if (paramReadCounter[ch] == 0) {
+            if (paramReadCounter[ch] == 0 && polyMode) {
+                int channels = polyChannels[ch];
+                outputs[FREQ_OUTPUT + ch].setChannels(std::max(channels, 1));
+                for (int c = 0; c < channels; c++) {
+                    float hz = polyBank[ch]->hz[c];
+                    outputs[FREQ_OUTPUT + ch].setVoltage(hz > 0.f ? log2f(hz / dsp::FREQ_C4) : 0.f, c);
+                }
+                if (channels == 0) outputs[FREQ_OUTPUT + ch].setVoltage(0.f);
+                currentVOct[ch] = (currentHz[ch] > 0.f) ? log2f(currentHz[ch] / dsp::FREQ_C4) : -999.f;
+            }
+            else if (paramReadCounter[ch] == 0) {
+                outputs[FREQ_OUTPUT + ch].setChannels(1);
                 if (currentHz[ch] > 0.f) {
                     // Standard VCV V/oct: 0V = C4 (261.6255653 Hz)
                     currentVOct[ch] = log2f(currentHz[ch] / dsp::FREQ_C4);
@@ -895,6 +1459,81 @@ struct TunerWidget : ModuleWidget {
         }
 
         menu->addChild(new MenuSeparator());
+        menu->addChild(createMenuLabel("Autocorrelation engine"));
+
+        struct EngineItem : MenuItem {
+            Tuner* module;
+            int    engine;
+            void onAction(const event::Action& e) override {
+                module->acEngine = engine;
+            }
+            void step() override {
+                rightText = (module->acEngine == engine) ? "✔" : "";
+                MenuItem::step();
+            }
+        };
+
+        struct EngineOption { const char* label; int engine; };
+        const std::vector<EngineOption> engineOptions = {
+            {"Time domain (default)",           DecimatedFrequencyTracker::TIME_DOMAIN_ENGINE},
+            {"FFT (4x overlap, faster update)", DecimatedFrequencyTracker::FFT_ENGINE},
+        };
+        for (auto& opt : engineOptions) {
+            auto* item   = new EngineItem();
+            item->text   = opt.label;
+            item->engine = opt.engine;
+            item->module = tunerModule;
+            menu->addChild(item);
+        }
+
+        menu->addChild(new MenuSeparator());
+        menu->addChild(createMenuLabel("Pitch detector"));
+
+        struct DetectorItem : MenuItem {
+            Tuner* module;
+            int    channel;
+            int    detector;
+            void onAction(const event::Action& e) override {
+                module->detector[channel] = detector;
+            }
+            void step() override {
+                rightText = (module->detector[channel] == detector) ? "✔" : "";
+                MenuItem::step();
+            }
+        };
+
+        struct DetectorOption { const char* label; int channel; int detector; };
+        const std::vector<DetectorOption> detectorOptions = {
+            {"Audio 1: Autocorrelation (default)", 0, DecimatedFrequencyTracker::AUTOCORRELATION_DETECTOR},
+            {"Audio 1: YIN (fewer octave errors)",0, DecimatedFrequencyTracker::YIN_DETECTOR},
+            {"Audio 2: Autocorrelation (default)", 1, DecimatedFrequencyTracker::AUTOCORRELATION_DETECTOR},
+            {"Audio 2: YIN (fewer octave errors)",1, DecimatedFrequencyTracker::YIN_DETECTOR},
+        };
+        for (auto& opt : detectorOptions) {
+            auto* item     = new DetectorItem();
+            item->text     = opt.label;
+            item->channel  = opt.channel;
+            item->detector = opt.detector;
+            item->module   = tunerModule;
+            menu->addChild(item);
+        }
+
+        menu->addChild(new MenuSeparator());
+
+        struct PolyModeItem : MenuItem {
+            Tuner* tunerModule;
+            void onAction(const event::Action& e) override {
+                tunerModule->setPolyMode(!tunerModule->polyMode);
+            }
+            void step() override {
+                rightText = tunerModule->polyMode ? "✔" : "";
+                MenuItem::step();
+            }
+        };
+        auto* polyModeItem        = new PolyModeItem();
+        polyModeItem->text        = "Polyphonic (track every channel)";
+        polyModeItem->tunerModule = tunerModule;
+        menu->addChild(polyModeItem);
 
         struct DisplayModeItem : MenuItem {
             Tuner* tunerModule;